@@ -3,6 +3,7 @@
 #include "AnimationRuntime.h"
 #include "KawaiiPhysicsBoneConstraintsDataAsset.h"
 #include "KawaiiPhysicsLimitsDataAsset.h"
+#include "KawaiiPhysicsRecorder.h"
 #include "Animation/AnimInstanceProxy.h"
 #include "Curves/CurveFloat.h"
 #include "Runtime/Launch/Resources/Version.h"
@@ -26,6 +27,15 @@ FAnimNode_KawaiiPhysics::FAnimNode_KawaiiPhysics()
 
 }
 
+FAnimNode_KawaiiPhysics::~FAnimNode_KawaiiPhysics()
+{
+	// Keep the frames recorded so far, copies of the node share the recording and the last one saves it
+	if (Recording.IsValid() && Recording.IsUnique())
+	{
+		FKawaiiPhysicsRecorder::FinishRecording(*this);
+	}
+}
+
 void FAnimNode_KawaiiPhysics::Initialize_AnyThread(const FAnimationInitializeContext& Context)
 {
 	FAnimNode_SkeletalControlBase::Initialize_AnyThread(Context);
@@ -46,6 +56,8 @@ void FAnimNode_KawaiiPhysics::CacheBones_AnyThread(const FAnimationCacheBonesCon
 {
 	FAnimNode_SkeletalControlBase::CacheBones_AnyThread(Context);
 
+	// Required bones change with the LOD, so only the bones of the current LOD are simulated
+	UpdateActiveModifyBones(Context.AnimInstanceProxy->GetRequiredBones());
 }
 
 void FAnimNode_KawaiiPhysics::ResetDynamics(ETeleportType InTeleportType)
@@ -79,14 +91,18 @@ void FAnimNode_KawaiiPhysics::EvaluateSkeletalControl_AnyThread(FComponentSpaceP
 	FTransform ComponentTransform = Output.AnimInstanceProxy->GetComponentTransform();
 
 #if WITH_EDITOR
-	// sync editing on other Nodes
-	if (LimitsDataAsset)
+	// sync editing on other Nodes, only after the data assets have changed
+	if (IsLimitsDataAssetChanged())
 	{ 
 		ApplyLimitsDataAsset(BoneContainer);
 	}
-	if (BoneConstraintsDataAsset)
+	if (IsBoneConstraintsDataAssetChanged())
 	{ 
 		ApplyBoneConstraintDataAsset(BoneContainer);
+		if (ModifyBones.Num() > 0)
+		{
+			InitBoneConstraints();
+		}
 	}
 
 	if(GUnrealEd && !GUnrealEd->IsPlayingSessionInEditor())
@@ -131,16 +147,24 @@ void FAnimNode_KawaiiPhysics::EvaluateSkeletalControl_AnyThread(FComponentSpaceP
 	// Update Bone Pose Transform
 	UpdateModifyBonesPoseTransform(Output, BoneContainer);
 	
+	// Record solver inputs, see p.KawaiiPhysics.Record
+	const bool bRecording = FKawaiiPhysicsRecorder::RecordInputs(*this, Output, ComponentTransform);
+
 	// Update SkeletalMeshComponent movement in World Space
 	UpdateSkelCompMove(ComponentTransform);
 
 	// Simulate Physics and Apply
+	const USkeletalMeshComponent* SkelComp = Output.AnimInstanceProxy->GetSkelMeshComponent();
 	if(bNeedWarmUp && WarmUpFrames > 0)
 	{
-		WarmUp(Output, BoneContainer, ComponentTransform);
+		WarmUp(SkelComp, ComponentTransform);
 		bNeedWarmUp = false;
 	}
-	SimulateModifyBones(Output, BoneContainer, ComponentTransform);
+	SimulateModifyBones(SkelComp, ComponentTransform);
+	if (bRecording)
+	{
+		FKawaiiPhysicsRecorder::RecordOutputs(*this);
+	}
 	ApplySimulateResult(Output, BoneContainer, OutBoneTransforms);
 }
 
@@ -153,15 +177,29 @@ bool FAnimNode_KawaiiPhysics::IsValidToEvaluate(const USkeleton* Skeleton, const
 
 bool FAnimNode_KawaiiPhysics::HasPreUpdate() const
 {
-#if WITH_EDITOR
+	// Only read when the PreUpdate node list is built, bEnableForceFields can change at runtime so PreUpdate checks it instead
 	return true;
-#else
-	return false;
-#endif
 }
 
+DECLARE_CYCLE_STAT(TEXT("KawaiiPhysics_GatherForceFields"), STAT_KawaiiPhysics_GatherForceFields, STATGROUP_Anim);
+
 void FAnimNode_KawaiiPhysics::PreUpdate(const UAnimInstance* InAnimInstance)
 {
+	ForceFields.Reset();
+	if (bEnableForceFields)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_KawaiiPhysics_GatherForceFields);
+
+		// Runs on the game thread, so the subsystem can be read safely
+		const USkeletalMeshComponent* SkelComp = InAnimInstance->GetSkelMeshComponent();
+		const UWorld* World = InAnimInstance->GetWorld();
+		UKawaiiPhysicsForceFieldSubsystem* ForceFieldSubsystem = World ? World->GetSubsystem<UKawaiiPhysicsForceFieldSubsystem>() : nullptr;
+		if (SkelComp && ForceFieldSubsystem)
+		{
+			ForceFieldSubsystem->GatherForceFields(SkelComp->Bounds, SkelComp->GetComponentTransform(), ForceFields);
+		}
+	}
+
 #if WITH_EDITOR
 	if(const UWorld* World =  InAnimInstance->GetWorld())
 	{
@@ -201,6 +239,25 @@ void FAnimNode_KawaiiPhysics::InitializeBoneReferences(const FBoneContainer& Req
 	{
 		BoneConstraint.InitializeBone(RequiredBones);
 	}
+
+	// Limits and constraints from data assets are only copied when the asset changes,
+	// so their bone references have to follow the required bones (e.g. LOD switches) here
+	for (auto& Sphere : SphericalLimitsData)
+	{
+		Sphere.DrivingBone.Initialize(RequiredBones);
+	}
+	for (auto& Capsule : CapsuleLimitsData)
+	{
+		Capsule.DrivingBone.Initialize(RequiredBones);
+	}
+	for (auto& Planer : PlanarLimitsData)
+	{
+		Planer.DrivingBone.Initialize(RequiredBones);
+	}
+	for (auto& BoneConstraint : BoneConstraintsData)
+	{
+		BoneConstraint.InitializeBone(RequiredBones);
+	}
 }
 
 DECLARE_CYCLE_STAT(TEXT("KawaiiPhysics_InitModifyBones"), STAT_KawaiiPhysics_InitModifyBones, STATGROUP_Anim);
@@ -209,6 +266,9 @@ void FAnimNode_KawaiiPhysics::InitModifyBones(FComponentSpacePoseContext& Output
 {
 	SCOPE_CYCLE_COUNTER(STAT_KawaiiPhysics_InitModifyBones);
 
+	// Recorded frames cannot continue across a rebuilt chain
+	FKawaiiPhysicsRecorder::FinishRecording(*this);
+
 	const USkeleton* Skeleton = BoneContainer.GetSkeletonAsset();
 	auto& RefSkeleton = Skeleton->GetReferenceSkeleton();
 
@@ -224,13 +284,57 @@ void FAnimNode_KawaiiPhysics::InitModifyBones(FComponentSpacePoseContext& Output
 		CalcBoneLength(ModifyBones[0], BoneContainer.GetRefPoseCompactArray());
 #endif
 	}
+
+	UpdateActiveModifyBones(BoneContainer);
+}
+
+void FAnimNode_KawaiiPhysics::UpdateActiveModifyBones(const FBoneContainer& BoneContainer)
+{
+	ActiveModifyBoneIndices.Reset(ModifyBones.Num());
+
+	// ModifyBones are added parents first, so the parent state is final when a child is visited
+	for (int32 i = 0; i < ModifyBones.Num(); ++i)
+	{
+		FKawaiiPhysicsModifyBone& Bone = ModifyBones[i];
+		const bool bWasActiveInLOD = Bone.bActiveInLOD;
+		
+		Bone.bActiveInLOD = Bone.bDummy ? ModifyBones[Bone.ParentIndex].bActiveInLOD : Bone.BoneRef.IsValidToEvaluate(BoneContainer);
+		Bone.ActiveChildNum = 0;
+		if (!Bone.bActiveInLOD)
+		{
+			Bone.bSkipSimulate = true;
+			Bone.ActiveParentIndex = INDEX_NONE;
+			if (ResetBoneTransformWhenBoneNotFound)
+			{
+				Bone.PoseLocation = FVector::ZeroVector;
+				Bone.PoseRotation = FQuat::Identity;
+				Bone.PoseScale = FVector::OneVector;
+			}
+			continue;
+		}
+
+		// Skip the joints removed by the LOD, the bone length is taken from the pose across them
+		int32 ActiveParentIndex = Bone.ParentIndex;
+		while (ActiveParentIndex >= 0 && !ModifyBones[ActiveParentIndex].bActiveInLOD)
+		{
+			ActiveParentIndex = ModifyBones[ActiveParentIndex].ParentIndex;
+		}
+		Bone.ActiveParentIndex = ActiveParentIndex;
+		if (ActiveParentIndex >= 0)
+		{
+			ModifyBones[ActiveParentIndex].ActiveChildNum++;
+		}
+
+		Bone.bResetLocation |= !bWasActiveInLOD;
+		ActiveModifyBoneIndices.Add(i);
+	}
 }
 
 void FAnimNode_KawaiiPhysics::ApplyLimitsDataAsset(const FBoneContainer& RequiredBones)
 {
-	SphericalLimitsData.Empty();
-	CapsuleLimitsData.Empty();
-	PlanarLimitsData.Empty();
+	SphericalLimitsData.Reset();
+	CapsuleLimitsData.Reset();
+	PlanarLimitsData.Reset();
 	if (LimitsDataAsset)
 	{
 		SphericalLimitsData = LimitsDataAsset->SphericalLimits;
@@ -238,6 +342,11 @@ void FAnimNode_KawaiiPhysics::ApplyLimitsDataAsset(const FBoneContainer& Require
 		PlanarLimitsData = LimitsDataAsset->PlanarLimits;
 	}
 
+#if WITH_EDITOR
+	AppliedLimitsDataAsset = LimitsDataAsset;
+	AppliedLimitsDataAssetRevision = LimitsDataAsset ? LimitsDataAsset->GetRevision() : 0;
+#endif
+
 	for (auto& Sphere : SphericalLimitsData)
 	{
 		Sphere.DrivingBone.Initialize(RequiredBones);
@@ -254,7 +363,7 @@ void FAnimNode_KawaiiPhysics::ApplyLimitsDataAsset(const FBoneContainer& Require
 
 void FAnimNode_KawaiiPhysics::ApplyBoneConstraintDataAsset(const FBoneContainer& RequiredBones)
 {
-	BoneConstraintsData.Empty();
+	BoneConstraintsData.Reset();
 	if(BoneConstraintsDataAsset)
 	{
 		BoneConstraintsData = BoneConstraintsDataAsset->GenerateBoneConstraints();
@@ -263,10 +372,29 @@ void FAnimNode_KawaiiPhysics::ApplyBoneConstraintDataAsset(const FBoneContainer&
 			BoneConstraint.InitializeBone(RequiredBones);
 		}
 	}
+
+#if WITH_EDITOR
+	AppliedBoneConstraintsDataAsset = BoneConstraintsDataAsset;
+	AppliedBoneConstraintsDataAssetRevision = BoneConstraintsDataAsset ? BoneConstraintsDataAsset->GetRevision() : 0;
+#endif
 }
 
+#if WITH_EDITOR
+bool FAnimNode_KawaiiPhysics::IsLimitsDataAssetChanged() const
+{
+	return LimitsDataAsset != AppliedLimitsDataAsset ||
+		(LimitsDataAsset && LimitsDataAsset->GetRevision() != AppliedLimitsDataAssetRevision);
+}
+
+bool FAnimNode_KawaiiPhysics::IsBoneConstraintsDataAssetChanged() const
+{
+	return BoneConstraintsDataAsset != AppliedBoneConstraintsDataAsset ||
+		(BoneConstraintsDataAsset && BoneConstraintsDataAsset->GetRevision() != AppliedBoneConstraintsDataAssetRevision);
+}
+#endif
+
 int32 FAnimNode_KawaiiPhysics::AddModifyBone(FComponentSpacePoseContext& Output, const FBoneContainer& BoneContainer, 
-                                             const FReferenceSkeleton& RefSkeleton, int32 BoneIndex)
+                                             const FReferenceSkeleton& RefSkeleton, int32 BoneIndex, int32 ParentModifyBoneIndex)
 {
 	if (BoneIndex < 0 || RefSkeleton.GetNum() < BoneIndex)
 	{
@@ -284,12 +412,28 @@ int32 FAnimNode_KawaiiPhysics::AddModifyBone(FComponentSpacePoseContext& Output,
 	FKawaiiPhysicsModifyBone NewModifyBone;
 	NewModifyBone.BoneRef = BoneRef;
 	NewModifyBone.BoneRef.Initialize(BoneContainer);
-	if (NewModifyBone.BoneRef.CachedCompactPoseIndex == INDEX_NONE)
+	const int32 MeshBoneIndex = BoneContainer.GetPoseBoneIndexForBoneName(BoneRef.BoneName);
+	if (MeshBoneIndex == INDEX_NONE)
 	{
 		return INDEX_NONE;
 	}
 
-	auto& RefBonePoseTransform = Output.Pose.GetComponentSpaceTransform(NewModifyBone.BoneRef.CachedCompactPoseIndex);
+	// Bones removed by the current LOD stay in the chain, placed by the reference pose under their parent
+	FTransform RefBonePoseTransform;
+	if (NewModifyBone.BoneRef.CachedCompactPoseIndex != INDEX_NONE)
+	{
+		RefBonePoseTransform = Output.Pose.GetComponentSpaceTransform(NewModifyBone.BoneRef.CachedCompactPoseIndex);
+	}
+	else if (ParentModifyBoneIndex >= 0)
+	{
+		const FKawaiiPhysicsModifyBone& ParentModifyBone = ModifyBones[ParentModifyBoneIndex];
+		RefBonePoseTransform = BoneContainer.GetReferenceSkeleton().GetRefBonePose()[MeshBoneIndex] *
+			FTransform(ParentModifyBone.PoseRotation, ParentModifyBone.PoseLocation, ParentModifyBone.PoseScale);
+	}
+	else
+	{
+		return INDEX_NONE;
+	}
 	NewModifyBone.Location = RefBonePoseTransform.GetLocation();  
 	NewModifyBone.PrevLocation = NewModifyBone.Location;
 	NewModifyBone.PoseLocation = NewModifyBone.Location;
@@ -306,7 +450,7 @@ int32 FAnimNode_KawaiiPhysics::AddModifyBone(FComponentSpacePoseContext& Output,
 		//for some mesh where tip bone is empty (without any skinning weight in the mesh), ChildBoneIndexs > 0 but no actual child bones are created
 		for (auto ChildBoneIndex : ChildBoneIndexs)
 		{
-			auto ChildModifyBoneIndex = AddModifyBone(Output, BoneContainer, RefSkeleton, ChildBoneIndex);
+			auto ChildModifyBoneIndex = AddModifyBone(Output, BoneContainer, RefSkeleton, ChildBoneIndex, ModifyBoneIndex);
 			if (ChildModifyBoneIndex >= 0)
 			{
 				ModifyBones[ModifyBoneIndex].ChildIndexs.Add(ChildModifyBoneIndex);
@@ -540,19 +684,28 @@ void FAnimNode_KawaiiPhysics::UpdatePlanerLimits(TArray<FPlanarLimit>& Limits, F
 
 void FAnimNode_KawaiiPhysics::UpdateModifyBonesPoseTransform(FComponentSpacePoseContext& Output, const FBoneContainer& BoneContainer)
 {
-	for (auto& Bone : ModifyBones)
+	for (const int32 BoneIndex : ActiveModifyBoneIndices)
 	{
+		auto& Bone = ModifyBones[BoneIndex];
 		if (!Bone.bDummy)
 		{
 			Bone.UpdatePoseTransform(BoneContainer, Output.Pose, ResetBoneTransformWhenBoneNotFound);
 		}
 		else
 		{
-			auto ParentBone = ModifyBones[Bone.ParentIndex];
+			const auto& ParentBone = ModifyBones[Bone.ParentIndex];
 			Bone.PoseLocation = ParentBone.PoseLocation + GetBoneForwardVector(ParentBone.PoseRotation) * DummyBoneLength;
 			Bone.PoseRotation = ParentBone.PoseRotation;
 			Bone.PoseScale = ParentBone.PoseScale;
 		}
+
+		if (Bone.bResetLocation)
+		{
+			Bone.Location = Bone.PoseLocation;
+			Bone.PrevLocation = Bone.PoseLocation;
+			Bone.PrevRotation = Bone.PoseRotation;
+			Bone.bResetLocation = false;
+		}
 	}
 }
 
@@ -580,7 +733,28 @@ DECLARE_CYCLE_STAT(TEXT("KawaiiPhysics_WorldCollision"), STAT_KawaiiPhysics_Worl
 DECLARE_CYCLE_STAT(TEXT("KawaiiPhysics_AdjustByCollision"), STAT_KawaiiPhysics_AdjustByCollision, STATGROUP_Anim);
 DECLARE_CYCLE_STAT(TEXT("KawaiiPhysics_AdjustByBoneConstraint"), STAT_KawaiiPhysics_AdjustByBoneConstraint, STATGROUP_Anim);
 
-void FAnimNode_KawaiiPhysics::SimulateModifyBones(FComponentSpacePoseContext& Output, const FBoneContainer& BoneContainer, FTransform& ComponentTransform)
+// Adds the cycles of a solver phase to PhaseTimings, if any
+struct FKawaiiPhysicsScopedPhaseTimer
+{
+	explicit FKawaiiPhysicsScopedPhaseTimer(uint64* InCycles)
+		: Cycles(InCycles)
+		, StartCycles(InCycles ? FPlatformTime::Cycles64() : 0)
+	{
+	}
+
+	~FKawaiiPhysicsScopedPhaseTimer()
+	{
+		if (Cycles)
+		{
+			*Cycles += FPlatformTime::Cycles64() - StartCycles;
+		}
+	}
+
+	uint64* Cycles;
+	uint64 StartCycles;
+};
+
+void FAnimNode_KawaiiPhysics::SimulateModifyBones(const USkeletalMeshComponent* SkelComp, const FTransform& ComponentTransform)
 {
 	SCOPE_CYCLE_COUNTER(STAT_KawaiiPhysics_SimulatemodifyBones);
 
@@ -589,45 +763,43 @@ void FAnimNode_KawaiiPhysics::SimulateModifyBones(FComponentSpacePoseContext& Ou
 		return;
 	}
 
-	const USkeletalMeshComponent* SkelComp = Output.AnimInstanceProxy->GetSkelMeshComponent();
-	
 	// Save Prev/Pose Info , Check SkipSimulate
-	for (FKawaiiPhysicsModifyBone& Bone : ModifyBones)
 	{
-		if (Bone.BoneRef.BoneIndex < 0 && !Bone.bDummy)
+		FKawaiiPhysicsScopedPhaseTimer PhaseTimer(PhaseTimings ? &PhaseTimings->SimulateCycles : nullptr);
+		for (const int32 BoneIndex : ActiveModifyBoneIndices)
 		{
-			Bone.bSkipSimulate = true;
-			continue;
-		}
-
-		if (Bone.ParentIndex < 0)
-		{
-			Bone.bSkipSimulate = true;
-			Bone.PrevLocation = Bone.Location;
-			Bone.Location = Bone.PoseLocation;
-			continue;
-		}
+			FKawaiiPhysicsModifyBone& Bone = ModifyBones[BoneIndex];
+			if (Bone.ActiveParentIndex < 0)
+			{
+				Bone.bSkipSimulate = true;
+				Bone.PrevLocation = Bone.Location;
+				Bone.Location = Bone.PoseLocation;
+				continue;
+			}
 		
-		Bone.bSkipSimulate = false;
-	}
+			Bone.bSkipSimulate = false;
+		}
 	
-	// Simulate
-	const float Exponent = TargetFramerate * DeltaTime;
-	const FVector GravityCS = ComponentTransform.InverseTransformVector(Gravity);
-	const UWorld* World = SkelComp ? SkelComp->GetWorld() : nullptr;
-	const FSceneInterface* Scene = World && World->Scene ? World->Scene : nullptr;
-	for (FKawaiiPhysicsModifyBone& Bone : ModifyBones)
-	{
-		if(Bone.bSkipSimulate)
+		// Simulate
+		const float Exponent = TargetFramerate * DeltaTime;
+		const FVector GravityCS = ComponentTransform.InverseTransformVector(Gravity);
+		const UWorld* World = SkelComp ? SkelComp->GetWorld() : nullptr;
+		const FSceneInterface* Scene = World && World->Scene ? World->Scene : nullptr;
+		for (const int32 BoneIndex : ActiveModifyBoneIndices)
 		{
-			continue;
+			FKawaiiPhysicsModifyBone& Bone = ModifyBones[BoneIndex];
+			if(Bone.bSkipSimulate)
+			{
+				continue;
+			}
+			Simulate(Bone, Scene, ComponentTransform, GravityCS, Exponent);
 		}
-		Simulate(Bone, Scene, ComponentTransform, GravityCS, Exponent);
 	}
 
 	// Adjust by Bone Constraints Before Collision
 	if (BoneConstraintIterationCountBeforeCollision > 0)
 	{
+		FKawaiiPhysicsScopedPhaseTimer PhaseTimer(PhaseTimings ? &PhaseTimings->BoneConstraintCycles : nullptr);
 		for (FModifyBoneConstraint& BoneConstraint : MergedBoneConstraints)
 		{
 			BoneConstraint.Lambda = 0.0f;
@@ -639,30 +811,35 @@ void FAnimNode_KawaiiPhysics::SimulateModifyBones(FComponentSpacePoseContext& Ou
 	}
 	
 	// Adjust by collisions
-	for (FKawaiiPhysicsModifyBone& Bone : ModifyBones)
 	{
-		if(Bone.bSkipSimulate)
+		FKawaiiPhysicsScopedPhaseTimer PhaseTimer(PhaseTimings ? &PhaseTimings->CollisionCycles : nullptr);
+		for (const int32 BoneIndex : ActiveModifyBoneIndices)
 		{
-			continue;
-		}
+			FKawaiiPhysicsModifyBone& Bone = ModifyBones[BoneIndex];
+			if(Bone.bSkipSimulate)
+			{
+				continue;
+			}
 
-		SCOPE_CYCLE_COUNTER(STAT_KawaiiPhysics_AdjustByCollision);
+			SCOPE_CYCLE_COUNTER(STAT_KawaiiPhysics_AdjustByCollision);
 		
-		AdjustBySphereCollision(Bone, SphericalLimits);
-		AdjustBySphereCollision(Bone, SphericalLimitsData);
-		AdjustByCapsuleCollision(Bone, CapsuleLimits);
-		AdjustByCapsuleCollision(Bone, CapsuleLimitsData);
-		AdjustByPlanerCollision(Bone, PlanarLimits);
-		AdjustByPlanerCollision(Bone, PlanarLimitsData);
-		if (bAllowWorldCollision)
-		{
-			AdjustByWorldCollision(Bone, SkelComp, BoneContainer);
+			AdjustBySphereCollision(Bone, SphericalLimits);
+			AdjustBySphereCollision(Bone, SphericalLimitsData);
+			AdjustByCapsuleCollision(Bone, CapsuleLimits);
+			AdjustByCapsuleCollision(Bone, CapsuleLimitsData);
+			AdjustByPlanerCollision(Bone, PlanarLimits);
+			AdjustByPlanerCollision(Bone, PlanarLimitsData);
+			if (bAllowWorldCollision)
+			{
+				AdjustByWorldCollision(Bone, SkelComp);
+			}
 		}
 	}
 
 	// Adjust by Bone Constraints After Collision
 	if (BoneConstraintIterationCountAfterCollision > 0)
 	{
+		FKawaiiPhysicsScopedPhaseTimer PhaseTimer(PhaseTimings ? &PhaseTimings->BoneConstraintCycles : nullptr);
 		for (FModifyBoneConstraint& BoneConstraint : MergedBoneConstraints)
 		{
 			BoneConstraint.Lambda = 0.0f;
@@ -674,24 +851,28 @@ void FAnimNode_KawaiiPhysics::SimulateModifyBones(FComponentSpacePoseContext& Ou
 	}
 
 	// Adjust by Limits ane Bone Length
-	for (FKawaiiPhysicsModifyBone& Bone : ModifyBones)
 	{
-		if(Bone.bSkipSimulate)
+		FKawaiiPhysicsScopedPhaseTimer PhaseTimer(PhaseTimings ? &PhaseTimings->AdjustCycles : nullptr);
+		for (const int32 BoneIndex : ActiveModifyBoneIndices)
 		{
-			continue;
-		}
+			FKawaiiPhysicsModifyBone& Bone = ModifyBones[BoneIndex];
+			if(Bone.bSkipSimulate)
+			{
+				continue;
+			}
 
-		auto& ParentBone = ModifyBones[Bone.ParentIndex];
+			auto& ParentBone = ModifyBones[Bone.ActiveParentIndex];
 
-		// Adjust by angle limit
-		AdjustByAngleLimit(Output, BoneContainer, ComponentTransform, Bone, ParentBone);
+			// Adjust by angle limit
+			AdjustByAngleLimit(Bone, ParentBone);
 
-		// Adjust by Planar Constraint
-		AdjustByPlanarConstraint(Bone, ParentBone);
+			// Adjust by Planar Constraint
+			AdjustByPlanarConstraint(Bone, ParentBone);
 
-		// Restore Bone Length
-		const float BoneLength = (Bone.PoseLocation - ParentBone.PoseLocation).Size();
-		Bone.Location = (Bone.Location - ParentBone.Location).GetSafeNormal() * BoneLength + ParentBone.Location;
+			// Restore Bone Length
+			const float BoneLength = (Bone.PoseLocation - ParentBone.PoseLocation).Size();
+			Bone.Location = (Bone.Location - ParentBone.Location).GetSafeNormal() * BoneLength + ParentBone.Location;
+		}
 	}
 
 	DeltaTimeOld = DeltaTime;
@@ -702,7 +883,7 @@ void FAnimNode_KawaiiPhysics::Simulate(FKawaiiPhysicsModifyBone& Bone, const FSc
 {
 	SCOPE_CYCLE_COUNTER(STAT_KawaiiPhysics_Simulate);
 	
-	const FKawaiiPhysicsModifyBone& ParentBone = ModifyBones[Bone.ParentIndex];
+	const FKawaiiPhysicsModifyBone& ParentBone = ModifyBones[Bone.ActiveParentIndex];
 
 	// Move using Velocity( = movement amount in pre frame ) and Damping
 	FVector Velocity = (Bone.Location - Bone.PrevLocation) / DeltaTimeOld;
@@ -734,6 +915,17 @@ void FAnimNode_KawaiiPhysics::Simulate(FKawaiiPhysicsModifyBone& Bone, const FSc
 		Bone.Location += GravityCS * DeltaTime;
 	}
 
+	// Force Fields
+	if (ForceFields.Num() > 0)
+	{
+		FVector ForceFieldAcceleration = FVector::ZeroVector;
+		for (const FKawaiiPhysicsForceField& ForceField : ForceFields)
+		{
+			ForceFieldAcceleration += ForceField.GetAcceleration(Bone.PrevLocation);
+		}
+		Bone.Location += 0.5 * ForceFieldAcceleration * ForceFieldScale * DeltaTime * DeltaTime;
+	}
+
 	// Pull to Pose Location
 	const FVector BaseLocation = ParentBone.Location + (Bone.PoseLocation - ParentBone.PoseLocation);
 	Bone.Location += (BaseLocation - Bone.Location) *
@@ -760,11 +952,11 @@ FVector FAnimNode_KawaiiPhysics::GetWindVelocity(const FSceneInterface* Scene, c
 	return WindVelocity;
 }
 
-void FAnimNode_KawaiiPhysics::AdjustByWorldCollision(FKawaiiPhysicsModifyBone& Bone, const USkeletalMeshComponent* OwningComp, const FBoneContainer& BoneContainer)
+void FAnimNode_KawaiiPhysics::AdjustByWorldCollision(FKawaiiPhysicsModifyBone& Bone, const USkeletalMeshComponent* OwningComp)
 {
 	SCOPE_CYCLE_COUNTER(STAT_KawaiiPhysics_WorldCollision);
 	
-	if (!OwningComp || Bone.ParentIndex < 0) 
+	if (!OwningComp || Bone.ActiveParentIndex < 0) 
 	{
 		return;
 	}
@@ -862,6 +1054,84 @@ void FAnimNode_KawaiiPhysics::AdjustByWorldCollision(FKawaiiPhysicsModifyBone& B
 	}
 }
 
+// First time in [0, 1] at which the segment from Start to End enters a sphere, Start has to be outside of the sphere.
+static bool GetSegmentSphereEntryTime(const FVector& Start, const FVector& End, const FVector& Center, float Radius, float& OutTime)
+{
+	const FVector Dir = End - Start;
+	const FVector StartOffset = Start - Center;
+	const float A = Dir.SizeSquared();
+	if (A < KINDA_SMALL_NUMBER)
+	{
+		return false;
+	}
+
+	const float B = 2.0f * FVector::DotProduct(Dir, StartOffset);
+	const float C = StartOffset.SizeSquared() - Radius * Radius;
+	const float Discriminant = B * B - 4.0f * A * C;
+	if (Discriminant < 0.0f)
+	{
+		return false;
+	}
+
+	const float Time = (-B - FMath::Sqrt(Discriminant)) / (2.0f * A);
+	if (Time < 0.0f || Time > 1.0f)
+	{
+		return false;
+	}
+
+	OutTime = Time;
+	return true;
+}
+
+// First time in [0, 1] at which the segment from Start to End enters a capsule around the segment from CapsuleStart to CapsuleEnd,
+// Start has to be outside of the capsule. The capsule is the union of the cylinder around its axis and the spheres at its ends.
+static bool GetSegmentCapsuleEntryTime(const FVector& Start, const FVector& End, const FVector& CapsuleStart, const FVector& CapsuleEnd, float Radius, float& OutTime)
+{
+	bool bHit = false;
+	float EntryTime = 1.0f;
+
+	const FVector Axis = CapsuleEnd - CapsuleStart;
+	const float AxisLength = Axis.Size();
+	if (AxisLength > KINDA_SMALL_NUMBER)
+	{
+		const FVector AxisDir = Axis / AxisLength;
+		const FVector Dir = End - Start;
+		const FVector StartOffset = Start - CapsuleStart;
+		const FVector DirPerp = Dir - FVector::DotProduct(Dir, AxisDir) * AxisDir;
+		const FVector StartOffsetPerp = StartOffset - FVector::DotProduct(StartOffset, AxisDir) * AxisDir;
+
+		const float A = DirPerp.SizeSquared();
+		const float B = 2.0f * FVector::DotProduct(DirPerp, StartOffsetPerp);
+		const float C = StartOffsetPerp.SizeSquared() - Radius * Radius;
+		const float Discriminant = B * B - 4.0f * A * C;
+		if (A > KINDA_SMALL_NUMBER && Discriminant >= 0.0f)
+		{
+			const float Time = (-B - FMath::Sqrt(Discriminant)) / (2.0f * A);
+			const float AxisPosition = FVector::DotProduct(StartOffset + Time * Dir, AxisDir);
+			if (Time >= 0.0f && Time <= 1.0f && AxisPosition >= 0.0f && AxisPosition <= AxisLength)
+			{
+				bHit = true;
+				EntryTime = Time;
+			}
+		}
+	}
+
+	float SphereTime;
+	if (GetSegmentSphereEntryTime(Start, End, CapsuleStart, Radius, SphereTime) && SphereTime < EntryTime)
+	{
+		bHit = true;
+		EntryTime = SphereTime;
+	}
+	if (GetSegmentSphereEntryTime(Start, End, CapsuleEnd, Radius, SphereTime) && SphereTime < EntryTime)
+	{
+		bHit = true;
+		EntryTime = SphereTime;
+	}
+
+	OutTime = EntryTime;
+	return bHit;
+}
+
 void FAnimNode_KawaiiPhysics::AdjustBySphereCollision(FKawaiiPhysicsModifyBone& Bone, TArray<FSphericalLimit>& Limits)
 {
 	for (auto& Sphere : Limits)
@@ -876,6 +1146,17 @@ void FAnimNode_KawaiiPhysics::AdjustBySphereCollision(FKawaiiPhysicsModifyBone&
 		{
 			if ((Bone.Location - Sphere.Location).SizeSquared() > LimitDistance * LimitDistance)
 			{
+				// The bone ended outside but may have passed through the sphere during this step
+				if (bEnableContinuousLimitCollision &&
+					(Bone.PrevLocation - Sphere.Location).SizeSquared() > LimitDistance * LimitDistance)
+				{
+					// Stop the bone where its path enters the sphere
+					float EntryTime;
+					if (GetSegmentSphereEntryTime(Bone.PrevLocation, Bone.Location, Sphere.Location, LimitDistance, EntryTime))
+					{
+						Bone.Location = FMath::Lerp(Bone.PrevLocation, Bone.Location, EntryTime);
+					}
+				}
 				continue;
 			}
 			else
@@ -924,6 +1205,17 @@ void FAnimNode_KawaiiPhysics::AdjustByCapsuleCollision(FKawaiiPhysicsModifyBone&
 			FVector ClosestPoint = FMath::ClosestPointOnSegment(Bone.Location, StartPoint, EndPoint);
 			Bone.Location = ClosestPoint + (Bone.Location - ClosestPoint).GetSafeNormal() * LimitDistance;
 		}
+		else if (bEnableContinuousLimitCollision &&
+			FMath::PointDistToSegmentSquared(Bone.PrevLocation, StartPoint, EndPoint) > LimitDistance * LimitDistance)
+		{
+			// The bone ended outside but may have passed through the capsule during this step
+			// Stop the bone where its path enters the capsule
+			float EntryTime;
+			if (GetSegmentCapsuleEntryTime(Bone.PrevLocation, Bone.Location, StartPoint, EndPoint, LimitDistance, EntryTime))
+			{
+				Bone.Location = FMath::Lerp(Bone.PrevLocation, Bone.Location, EntryTime);
+			}
+		}
 	}
 }
 
@@ -948,8 +1240,7 @@ void FAnimNode_KawaiiPhysics::AdjustByPlanerCollision(FKawaiiPhysicsModifyBone&
 	}
 }
 
-void FAnimNode_KawaiiPhysics::AdjustByAngleLimit(FComponentSpacePoseContext& Output, const FBoneContainer& BoneContainer, FTransform& ComponentTransform, 
-	FKawaiiPhysicsModifyBone& Bone, const FKawaiiPhysicsModifyBone& ParentBone)
+void FAnimNode_KawaiiPhysics::AdjustByAngleLimit(FKawaiiPhysicsModifyBone& Bone, const FKawaiiPhysicsModifyBone& ParentBone)
 {
 	if (Bone.PhysicsSettings.LimitAngle == 0.0f)
 	{
@@ -1016,6 +1307,10 @@ void FAnimNode_KawaiiPhysics::AdjustByBoneConstraints()
 
 		FKawaiiPhysicsModifyBone& ModifyBone1 = ModifyBones[BoneConstraint.ModifyBoneIndex1];
 		FKawaiiPhysicsModifyBone& ModifyBone2 = ModifyBones[BoneConstraint.ModifyBoneIndex2];
+		if (!ModifyBone1.bActiveInLOD || !ModifyBone2.bActiveInLOD)
+		{
+			continue;
+		}
 		EXPBDComplianceType ComplianceType = BoneConstraint.bOverrideCompliance ? BoneConstraint.ComplianceType : BoneConstraintGlobalComplianceType;
 
 		FVector Delta = ModifyBone2.Location - ModifyBone1.Location;
@@ -1044,14 +1339,13 @@ void FAnimNode_KawaiiPhysics::AdjustByBoneConstraints()
 }
 
 DECLARE_CYCLE_STAT(TEXT("KawaiiPhysics_WarmUp"), STAT_KawaiiPhysics_WarmUp, STATGROUP_Anim);
-void FAnimNode_KawaiiPhysics::WarmUp(FComponentSpacePoseContext& Output, const FBoneContainer& BoneContainer,
-	FTransform& ComponentTransform)
+void FAnimNode_KawaiiPhysics::WarmUp(const USkeletalMeshComponent* SkelComp, const FTransform& ComponentTransform)
 {
 	SCOPE_CYCLE_COUNTER(STAT_KawaiiPhysics_WarmUp);
 	
 	for(int32 i = 0; i < WarmUpFrames; ++i)
 	{
-		SimulateModifyBones(Output, BoneContainer, ComponentTransform);
+		SimulateModifyBones(SkelComp, ComponentTransform);
 	}
 }
 
@@ -1118,18 +1412,24 @@ void FAnimNode_KawaiiPhysics::InitBoneConstraints()
 
 void FAnimNode_KawaiiPhysics::ApplySimulateResult(FComponentSpacePoseContext& Output, const FBoneContainer& BoneContainer, TArray<FBoneTransform>& OutBoneTransforms)
 {
-	for (int32 i = 0; i < ModifyBones.Num(); ++i)
+	// Indexed by ModifyBones, entries of bones outside the current LOD keep an invalid index and are removed below
+	OutBoneTransforms.SetNum(ModifyBones.Num());
+	for (const int32 i : ActiveModifyBoneIndices)
 	{
-		OutBoneTransforms.Add(FBoneTransform(ModifyBones[i].BoneRef.GetCompactPoseIndex(BoneContainer), 
-			FTransform(ModifyBones[i].PoseRotation, ModifyBones[i].PoseLocation, ModifyBones[i].PoseScale)));
+		OutBoneTransforms[i] = FBoneTransform(ModifyBones[i].BoneRef.GetCompactPoseIndex(BoneContainer), 
+			FTransform(ModifyBones[i].PoseRotation, ModifyBones[i].PoseLocation, ModifyBones[i].PoseScale));
 	}	
 
-	for (int32 i = 1; i < ModifyBones.Num(); ++i)
+	for (const int32 i : ActiveModifyBoneIndices)
 	{
 		FKawaiiPhysicsModifyBone& Bone = ModifyBones[i];
-		FKawaiiPhysicsModifyBone& ParentBone = ModifyBones[Bone.ParentIndex];
+		if (Bone.ActiveParentIndex < 0)
+		{
+			continue;
+		}
+		FKawaiiPhysicsModifyBone& ParentBone = ModifyBones[Bone.ActiveParentIndex];
 
-		if (ParentBone.ChildIndexs.Num() <= 1)
+		if (ParentBone.ActiveChildNum <= 1)
 		{
 			if (ParentBone.BoneRef.BoneIndex >= 0)
 			{
@@ -1148,7 +1448,7 @@ void FAnimNode_KawaiiPhysics::ApplySimulateResult(FComponentSpacePoseContext& Ou
 				}
 
 				FQuat SimulateRotation = FQuat::FindBetweenVectors(PoseVector, SimulateVector) * ParentBone.PoseRotation;
-				OutBoneTransforms[Bone.ParentIndex].Transform.SetRotation(SimulateRotation);
+				OutBoneTransforms[Bone.ActiveParentIndex].Transform.SetRotation(SimulateRotation);
 				ParentBone.PrevRotation = SimulateRotation;
 			}
 		}
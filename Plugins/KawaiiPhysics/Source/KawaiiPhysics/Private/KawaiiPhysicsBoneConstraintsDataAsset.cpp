@@ -52,6 +52,7 @@ void UKawaiiPhysicsBoneConstraintsDataAsset::ApplyRegex()
 			BoneConstraintsData.Add(BoneConstraintData);
 		}
 	}
+	++Revision;
 
 	GEditor->EndTransaction();
 }
@@ -89,6 +90,8 @@ void UKawaiiPhysicsBoneConstraintsDataAsset::PostEditChangeProperty(FPropertyCha
 	{
 		UpdatePreviewBoneList();
 	}
+
+	++Revision;
 }
 
 #undef LOCTEXT_NAMESPACE
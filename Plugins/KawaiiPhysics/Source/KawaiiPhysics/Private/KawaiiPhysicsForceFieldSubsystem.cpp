@@ -0,0 +1,147 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "KawaiiPhysicsForceFieldSubsystem.h"
+
+#include "Engine/World.h"
+
+FVector FKawaiiPhysicsForceField::GetAcceleration(const FVector& Position) const
+{
+	const FVector ToPosition = Position - Location;
+
+	float Scale = Strength;
+	if (Radius > 0.0f)
+	{
+		const float DistanceSquared = ToPosition.SizeSquared();
+		if (DistanceSquared >= Radius * Radius)
+		{
+			return FVector::ZeroVector;
+		}
+		if (bLinearFalloff)
+		{
+			Scale *= 1.0f - FMath::Sqrt(DistanceSquared) / Radius;
+		}
+	}
+
+	switch (Type)
+	{
+	default:
+	case EKawaiiPhysicsForceFieldType::Radial:
+		return ToPosition.GetSafeNormal() * Scale;
+	case EKawaiiPhysicsForceFieldType::Directional:
+		return Direction * Scale;
+	case EKawaiiPhysicsForceFieldType::Vortex:
+		return FVector::CrossProduct(Direction, ToPosition).GetSafeNormal() * Scale;
+	}
+}
+
+FKawaiiPhysicsForceFieldHandle UKawaiiPhysicsForceFieldSubsystem::AddForceField(const FKawaiiPhysicsForceField& ForceField)
+{
+	FEntry Entry;
+	Entry.ForceField = ForceField;
+	Entry.ForceField.Direction = ForceField.Direction.GetSafeNormal();
+	Entry.EndTime = GetEndTime(ForceField);
+	Entry.Serial = NextSerial++;
+
+	FKawaiiPhysicsForceFieldHandle Handle;
+	Handle.Index = Entries.Add(Entry);
+	Handle.Serial = Entry.Serial;
+	bDirty = true;
+
+	return Handle;
+}
+
+bool UKawaiiPhysicsForceFieldSubsystem::UpdateForceField(const FKawaiiPhysicsForceFieldHandle& Handle, const FKawaiiPhysicsForceField& ForceField)
+{
+	if (!Handle.IsValid() || !Entries.IsValidIndex(Handle.Index) || Entries[Handle.Index].Serial != Handle.Serial)
+	{
+		return false;
+	}
+
+	FEntry& Entry = Entries[Handle.Index];
+	Entry.ForceField = ForceField;
+	Entry.ForceField.Direction = ForceField.Direction.GetSafeNormal();
+	Entry.EndTime = GetEndTime(ForceField);
+	bDirty = true;
+
+	return true;
+}
+
+void UKawaiiPhysicsForceFieldSubsystem::RemoveForceField(FKawaiiPhysicsForceFieldHandle& Handle)
+{
+	if (Handle.IsValid() && Entries.IsValidIndex(Handle.Index) && Entries[Handle.Index].Serial == Handle.Serial)
+	{
+		Entries.RemoveAt(Handle.Index);
+		bDirty = true;
+	}
+
+	Handle = FKawaiiPhysicsForceFieldHandle();
+}
+
+void UKawaiiPhysicsForceFieldSubsystem::GatherForceFields(const FBoxSphereBounds& Bounds, const FTransform& ComponentTransform,
+	TArray<FKawaiiPhysicsForceField>& OutForceFields)
+{
+	if (Entries.Num() == 0)
+	{
+		return;
+	}
+
+	if (bDirty || FlattenedFrame != GFrameCounter)
+	{
+		FlattenForceFields();
+	}
+
+	const float InvScale = 1.0f / FMath::Max(ComponentTransform.GetMaximumAxisScale(), SMALL_NUMBER);
+	for (const FKawaiiPhysicsForceField& ForceField : FlattenedForceFields)
+	{
+		if (ForceField.Radius > 0.0f &&
+			FVector::DistSquared(ForceField.Location, Bounds.Origin) > FMath::Square(ForceField.Radius + Bounds.SphereRadius))
+		{
+			continue;
+		}
+
+		FKawaiiPhysicsForceField& ForceFieldCS = OutForceFields.Add_GetRef(ForceField);
+		ForceFieldCS.Location = ComponentTransform.InverseTransformPosition(ForceField.Location);
+		ForceFieldCS.Direction = ComponentTransform.InverseTransformVectorNoScale(ForceField.Direction);
+		ForceFieldCS.Strength = ForceField.Strength * InvScale;
+		ForceFieldCS.Radius = ForceField.Radius * InvScale;
+	}
+}
+
+void UKawaiiPhysicsForceFieldSubsystem::FlattenForceFields()
+{
+	// Drop expired fields once per frame
+	const UWorld* World = GetWorld();
+	const double Time = World ? World->GetTimeSeconds() : 0.0;
+	for (auto It = Entries.CreateIterator(); It; ++It)
+	{
+		if (It->EndTime > 0.0 && It->EndTime <= Time)
+		{
+			It.RemoveCurrent();
+			bDirty = true;
+		}
+	}
+
+	if (bDirty)
+	{
+		FlattenedForceFields.Reset(Entries.Num());
+		for (const FEntry& Entry : Entries)
+		{
+			FlattenedForceFields.Add(Entry.ForceField);
+		}
+		bDirty = false;
+	}
+
+	FlattenedFrame = GFrameCounter;
+}
+
+double UKawaiiPhysicsForceFieldSubsystem::GetEndTime(const FKawaiiPhysicsForceField& ForceField) const
+{
+	const UWorld* World = GetWorld();
+	if (ForceField.Duration <= 0.0f || !World)
+	{
+		return 0.0;
+	}
+
+	return World->GetTimeSeconds() + ForceField.Duration;
+}
@@ -202,6 +202,33 @@ float UKawaiiPhysicsLibrary::GetWindScale(const FKawaiiPhysicsReference& KawaiiP
 	return WindScale;
 }
 
+FKawaiiPhysicsReference UKawaiiPhysicsLibrary::SetEnableForceFields(
+	const FKawaiiPhysicsReference& KawaiiPhysics, bool EnableForceFields)
+{
+	KawaiiPhysics.CallAnimNodeFunction<FAnimNode_KawaiiPhysics>(
+		TEXT("SetEnableForceFields"),
+		[EnableForceFields](FAnimNode_KawaiiPhysics& InKawaiiPhysics)
+		{
+			InKawaiiPhysics.bEnableForceFields = EnableForceFields;
+		});
+
+	return KawaiiPhysics;
+}
+
+bool UKawaiiPhysicsLibrary::GetEnableForceFields(const FKawaiiPhysicsReference& KawaiiPhysics)
+{
+	bool EnableForceFields;
+	
+	KawaiiPhysics.CallAnimNodeFunction<FAnimNode_KawaiiPhysics>(
+	TEXT("GetEnableForceFields"),
+	[&EnableForceFields](FAnimNode_KawaiiPhysics& InKawaiiPhysics)
+	{
+		EnableForceFields = InKawaiiPhysics.bEnableForceFields;
+	});
+
+	return EnableForceFields;
+}
+
 FKawaiiPhysicsReference UKawaiiPhysicsLibrary::SetAllowWorldCollision(
 	const FKawaiiPhysicsReference& KawaiiPhysics, bool AllowWorldCollision)
 {
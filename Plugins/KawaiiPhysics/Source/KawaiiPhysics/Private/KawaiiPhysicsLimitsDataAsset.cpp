@@ -58,6 +58,8 @@ void UKawaiiPhysicsLimitsDataAsset::Sync()
 	SyncCollisionLimits(SphericalLimitsData, SphericalLimits);
 	SyncCollisionLimits(CapsuleLimitsData, CapsuleLimits);
 	SyncCollisionLimits(PlanarLimitsData, PlanarLimits);
+
+	++Revision;
 }
 
 void UKawaiiPhysicsLimitsDataAsset::PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent)
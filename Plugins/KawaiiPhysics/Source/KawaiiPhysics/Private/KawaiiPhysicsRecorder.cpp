@@ -0,0 +1,428 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "KawaiiPhysicsRecorder.h"
+
+#include <atomic>
+
+#include "AnimNode_KawaiiPhysics.h"
+#include "Animation/AnimInstanceProxy.h"
+#include "Async/Async.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Containers/Ticker.h"
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/ObjectAndNameAsStringProxyArchive.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogKawaiiPhysicsRecorder, Log, All);
+
+TAutoConsoleVariable<int32> CVarKawaiiPhysicsRecordFrames(TEXT("p.KawaiiPhysics.RecordFrames"), 300,
+	TEXT("Number of frames recorded per KawaiiPhysics node by p.KawaiiPhysics.Record."));
+
+// Frame of the last p.KawaiiPhysics.Record, nodes evaluated shortly after it start recording
+static std::atomic<uint64> GKawaiiPhysicsRecordingRequestFrame(0);
+static constexpr uint64 KawaiiPhysicsRecordingRequestWindow = 2;
+
+TAutoConsoleVariable<float> CVarKawaiiPhysicsRecordTimeout(TEXT("p.KawaiiPhysics.RecordTimeout"), 10.0f,
+	TEXT("Seconds after which the recording of a KawaiiPhysics node that stopped evaluating is saved."));
+
+// Recordings in progress, the nodes own them
+static FCriticalSection GKawaiiPhysicsActiveRecordingsLock;
+static TArray<TWeakPtr<FKawaiiPhysicsRecording>> GKawaiiPhysicsActiveRecordings;
+static FTSTicker::FDelegateHandle GKawaiiPhysicsStaleRecordingsTicker;
+
+static FAutoConsoleCommand KawaiiPhysicsRecordCommand(TEXT("p.KawaiiPhysics.Record"),
+	TEXT("Record the solver inputs of every evaluated KawaiiPhysics node for p.KawaiiPhysics.RecordFrames frames. Replay the files with the KawaiiPhysicsReplay commandlet."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		GKawaiiPhysicsRecordingRequestFrame = GFrameCounter;
+	}));
+
+// Visits the limits in the order they are stored in FKawaiiPhysicsRecordedFrame
+template <typename FuncType>
+static void ForEachLimit(FAnimNode_KawaiiPhysics& Node, FuncType Func)
+{
+	for (auto& Limit : Node.SphericalLimits) { Func(Limit); }
+	for (auto& Limit : Node.SphericalLimitsData) { Func(Limit); }
+	for (auto& Limit : Node.CapsuleLimits) { Func(Limit); }
+	for (auto& Limit : Node.CapsuleLimitsData) { Func(Limit); }
+	for (auto& Limit : Node.PlanarLimits) { Func(Limit); }
+	for (auto& Limit : Node.PlanarLimitsData) { Func(Limit); }
+}
+
+FArchive& operator<<(FArchive& Ar, FKawaiiPhysicsRecordedFrame& Frame)
+{
+	Ar << Frame.DeltaTime;
+	Ar << Frame.ComponentTransform;
+	Ar << Frame.PoseLocations;
+	Ar << Frame.PoseRotations;
+	Ar << Frame.PoseScales;
+	Ar << Frame.LimitLocations;
+	Ar << Frame.LimitRotations;
+	Ar << Frame.LimitEnables;
+
+	int32 NumForceFields = Frame.ForceFields.Num();
+	Ar << NumForceFields;
+	if (Ar.IsLoading())
+	{
+		Frame.ForceFields.SetNum(NumForceFields);
+	}
+	for (FKawaiiPhysicsForceField& ForceField : Frame.ForceFields)
+	{
+		Ar << ForceField.Type;
+		Ar << ForceField.Location;
+		Ar << ForceField.Direction;
+		Ar << ForceField.Strength;
+		Ar << ForceField.Radius;
+		Ar << ForceField.bLinearFalloff;
+	}
+
+	Ar << Frame.OutputLocations;
+
+	return Ar;
+}
+
+FArchive& operator<<(FArchive& Ar, FKawaiiPhysicsRecording& Recording)
+{
+	uint32 Magic = FKawaiiPhysicsRecording::FileMagic;
+	uint32 Version = FKawaiiPhysicsRecording::FileVersion;
+	Ar << Magic;
+	Ar << Version;
+	if (Ar.IsLoading() && (Magic != FKawaiiPhysicsRecording::FileMagic || Version != FKawaiiPhysicsRecording::FileVersion))
+	{
+		Ar.SetError();
+		return Ar;
+	}
+
+	Ar << Recording.Name;
+	Ar << Recording.NodeData;
+	Ar << Recording.ActiveModifyBoneIndices;
+	Ar << Recording.DeltaTimeOld;
+	Ar << Recording.Frames;
+
+	return Ar;
+}
+
+bool FKawaiiPhysicsRecording::SaveToFile(const FString& Filename) const
+{
+	TArray<uint8> Data;
+	FMemoryWriter Writer(Data);
+	Writer << const_cast<FKawaiiPhysicsRecording&>(*this);
+
+	return FFileHelper::SaveArrayToFile(Data, *Filename);
+}
+
+bool FKawaiiPhysicsRecording::LoadFromFile(const FString& Filename)
+{
+	TArray<uint8> Data;
+	if (!FFileHelper::LoadFileToArray(Data, *Filename))
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(Data);
+	Reader << *this;
+
+	return !Reader.IsError();
+}
+
+bool FKawaiiPhysicsRecorder::RecordInputs(FAnimNode_KawaiiPhysics& Node, const FComponentSpacePoseContext& Output, const FTransform& ComponentTransform)
+{
+	if (Node.Recording.IsValid() && Node.Recording->bFinished)
+	{
+		// Saved by the recorder while the node was not evaluated
+		Node.Recording.Reset();
+		return false;
+	}
+
+	if (!Node.Recording.IsValid())
+	{
+		const uint64 RequestFrame = GKawaiiPhysicsRecordingRequestFrame.load(std::memory_order_relaxed);
+		if (RequestFrame == 0 || RequestFrame == Node.HandledRecordingRequestFrame ||
+			GFrameCounter > RequestFrame + KawaiiPhysicsRecordingRequestWindow)
+		{
+			return false;
+		}
+		Node.HandledRecordingRequestFrame = RequestFrame;
+
+		FKawaiiPhysicsRecording& NewRecording = *(Node.Recording = MakeShared<FKawaiiPhysicsRecording>());
+		const USkeletalMeshComponent* SkelComp = Output.AnimInstanceProxy->GetSkelMeshComponent();
+		const AActor* Owner = SkelComp ? SkelComp->GetOwner() : nullptr;
+		NewRecording.SkelComp = SkelComp;
+		NewRecording.Name = FString::Printf(TEXT("%s_%s"), Owner ? *Owner->GetName() : TEXT("None"), *Node.RootBone.BoneName.ToString());
+		NewRecording.ActiveModifyBoneIndices = Node.ActiveModifyBoneIndices;
+		NewRecording.DeltaTimeOld = Node.DeltaTimeOld;
+
+		FMemoryWriter Writer(NewRecording.NodeData);
+		FObjectAndNameAsStringProxyArchive Ar(Writer, false);
+		FAnimNode_KawaiiPhysics::StaticStruct()->SerializeItem(Ar, &Node, nullptr);
+
+		AddActiveRecording(Node.Recording);
+	}
+	else if (Node.Recording->Frames.Num() >= CVarKawaiiPhysicsRecordFrames.GetValueOnAnyThread() ||
+		Node.Recording->ActiveModifyBoneIndices != Node.ActiveModifyBoneIndices)
+	{
+		// The recorded bone layout cannot follow LOD switches
+		FinishRecording(Node);
+		return false;
+	}
+
+	Node.Recording->LastRecordTime = FPlatformTime::Seconds();
+
+	FKawaiiPhysicsRecordedFrame& Frame = Node.Recording->Frames.AddDefaulted_GetRef();
+	Frame.DeltaTime = Node.DeltaTime;
+	Frame.ComponentTransform = ComponentTransform;
+
+	const int32 NumBones = Node.ActiveModifyBoneIndices.Num();
+	Frame.PoseLocations.Reserve(NumBones);
+	Frame.PoseRotations.Reserve(NumBones);
+	Frame.PoseScales.Reserve(NumBones);
+	for (const int32 BoneIndex : Node.ActiveModifyBoneIndices)
+	{
+		const FKawaiiPhysicsModifyBone& Bone = Node.ModifyBones[BoneIndex];
+		Frame.PoseLocations.Add(Bone.PoseLocation);
+		Frame.PoseRotations.Add(Bone.PoseRotation);
+		Frame.PoseScales.Add(Bone.PoseScale);
+	}
+
+	ForEachLimit(Node, [&Frame](const FCollisionLimitBase& Limit)
+	{
+		Frame.LimitLocations.Add(Limit.Location);
+		Frame.LimitRotations.Add(Limit.Rotation);
+		Frame.LimitEnables.Add(Limit.bEnable);
+	});
+
+	Frame.ForceFields = Node.ForceFields;
+
+	return true;
+}
+
+void FKawaiiPhysicsRecorder::RecordOutputs(FAnimNode_KawaiiPhysics& Node)
+{
+	if (!Node.Recording.IsValid() || Node.Recording->Frames.Num() == 0)
+	{
+		return;
+	}
+
+	FKawaiiPhysicsRecordedFrame& Frame = Node.Recording->Frames.Last();
+	Frame.OutputLocations.Reserve(Node.ActiveModifyBoneIndices.Num());
+	for (const int32 BoneIndex : Node.ActiveModifyBoneIndices)
+	{
+		Frame.OutputLocations.Add(Node.ModifyBones[BoneIndex].Location);
+	}
+}
+
+void FKawaiiPhysicsRecorder::FinishRecording(FAnimNode_KawaiiPhysics& Node)
+{
+	if (!Node.Recording.IsValid())
+	{
+		return;
+	}
+
+	// The recorder may have saved it already while the node was not evaluated
+	if (!Node.Recording->bFinished.exchange(true))
+	{
+		SaveRecordingAsync(Node.Recording);
+	}
+
+	Node.Recording.Reset();
+}
+
+void FKawaiiPhysicsRecorder::SaveRecordingAsync(const TSharedPtr<FKawaiiPhysicsRecording>& Recording)
+{
+	if (Recording->Frames.Num() == 0)
+	{
+		return;
+	}
+
+	// Called from the animation worker threads, the file is written on a background thread
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [Recording]()
+	{
+		const FString Filename = FPaths::Combine(GetRecordingDir(),
+			FString::Printf(TEXT("%s_%s.kprec"), *Recording->Name, *FDateTime::Now().ToString()));
+		if (Recording->SaveToFile(Filename))
+		{
+			UE_LOG(LogKawaiiPhysicsRecorder, Log, TEXT("Recorded %d frames to %s"), Recording->Frames.Num(), *Filename);
+		}
+		else
+		{
+			UE_LOG(LogKawaiiPhysicsRecorder, Warning, TEXT("Failed to save recording to %s"), *Filename);
+		}
+	});
+}
+
+void FKawaiiPhysicsRecorder::AddActiveRecording(const TSharedPtr<FKawaiiPhysicsRecording>& Recording)
+{
+	FScopeLock Lock(&GKawaiiPhysicsActiveRecordingsLock);
+
+	GKawaiiPhysicsActiveRecordings.Add(Recording);
+
+	if (!GKawaiiPhysicsStaleRecordingsTicker.IsValid())
+	{
+		GKawaiiPhysicsStaleRecordingsTicker = FTSTicker::GetCoreTicker().AddTicker(
+			FTickerDelegate::CreateStatic(&FKawaiiPhysicsRecorder::SaveStaleRecordings));
+	}
+}
+
+bool FKawaiiPhysicsRecorder::SaveStaleRecordings(float DeltaTime)
+{
+	FScopeLock Lock(&GKawaiiPhysicsActiveRecordingsLock);
+
+	// Throttled nodes skip frames, only a destroyed component or a long pause ends their recording
+	const double StaleTime = FPlatformTime::Seconds() - CVarKawaiiPhysicsRecordTimeout.GetValueOnGameThread();
+
+	// The core ticker runs between frames, no node is appending frames at this point
+	for (int32 Index = GKawaiiPhysicsActiveRecordings.Num() - 1; Index >= 0; --Index)
+	{
+		const TSharedPtr<FKawaiiPhysicsRecording> Recording = GKawaiiPhysicsActiveRecordings[Index].Pin();
+		if (!Recording.IsValid() || Recording->bFinished)
+		{
+			GKawaiiPhysicsActiveRecordings.RemoveAtSwap(Index);
+		}
+		else if (Recording->SkelComp.IsStale(true) || Recording->LastRecordTime < StaleTime)
+		{
+			Recording->bFinished = true;
+			SaveRecordingAsync(Recording);
+			GKawaiiPhysicsActiveRecordings.RemoveAtSwap(Index);
+		}
+	}
+
+	if (GKawaiiPhysicsActiveRecordings.Num() == 0)
+	{
+		GKawaiiPhysicsStaleRecordingsTicker.Reset();
+		return false;
+	}
+
+	return true;
+}
+
+bool FKawaiiPhysicsRecorder::Replay(const FKawaiiPhysicsRecording& Recording, int32 NumIterations, FKawaiiPhysicsReplayResult& OutResult)
+{
+	OutResult = FKawaiiPhysicsReplayResult();
+	OutResult.NumFrames = Recording.Frames.Num();
+	OutResult.NumBones = Recording.ActiveModifyBoneIndices.Num();
+	OutResult.NumIterations = FMath::Max(NumIterations, 1);
+
+	double DivergenceSum = 0.0;
+	int32 NumDivergenceSamples = 0;
+
+	for (int32 Iteration = 0; Iteration < OutResult.NumIterations; ++Iteration)
+	{
+		// Restart from the recorded state each iteration
+		FAnimNode_KawaiiPhysics Node;
+		{
+			FMemoryReader Reader(Recording.NodeData);
+			FObjectAndNameAsStringProxyArchive Ar(Reader, true);
+			FAnimNode_KawaiiPhysics::StaticStruct()->SerializeItem(Ar, &Node, nullptr);
+			if (Reader.IsError())
+			{
+				UE_LOG(LogKawaiiPhysicsRecorder, Error, TEXT("Failed to read the node of recording %s"), *Recording.Name);
+				return false;
+			}
+		}
+
+		for (const int32 BoneIndex : Recording.ActiveModifyBoneIndices)
+		{
+			if (!Node.ModifyBones.IsValidIndex(BoneIndex))
+			{
+				UE_LOG(LogKawaiiPhysicsRecorder, Error, TEXT("Recording %s does not match its modify bones"), *Recording.Name);
+				return false;
+			}
+		}
+		Node.ActiveModifyBoneIndices = Recording.ActiveModifyBoneIndices;
+		Node.DeltaTimeOld = Recording.DeltaTimeOld;
+		Node.PhaseTimings = &OutResult.PhaseTimings;
+
+		for (int32 FrameIndex = 0; FrameIndex < Recording.Frames.Num(); ++FrameIndex)
+		{
+			const FKawaiiPhysicsRecordedFrame& Frame = Recording.Frames[FrameIndex];
+			if (Frame.PoseLocations.Num() != OutResult.NumBones || Frame.OutputLocations.Num() != OutResult.NumBones)
+			{
+				UE_LOG(LogKawaiiPhysicsRecorder, Error, TEXT("Frame %d of recording %s is incomplete"), FrameIndex, *Recording.Name);
+				return false;
+			}
+
+			for (int32 i = 0; i < OutResult.NumBones; ++i)
+			{
+				FKawaiiPhysicsModifyBone& Bone = Node.ModifyBones[Node.ActiveModifyBoneIndices[i]];
+				Bone.PoseLocation = Frame.PoseLocations[i];
+				Bone.PoseRotation = Frame.PoseRotations[i];
+				Bone.PoseScale = Frame.PoseScales[i];
+			}
+
+			int32 LimitIndex = 0;
+			bool bLimitsMatch = true;
+			ForEachLimit(Node, [&](FCollisionLimitBase& Limit)
+			{
+				if (!Frame.LimitLocations.IsValidIndex(LimitIndex))
+				{
+					bLimitsMatch = false;
+					return;
+				}
+				Limit.Location = Frame.LimitLocations[LimitIndex];
+				Limit.Rotation = Frame.LimitRotations[LimitIndex];
+				Limit.bEnable = Frame.LimitEnables[LimitIndex];
+				++LimitIndex;
+			});
+			if (!bLimitsMatch)
+			{
+				UE_LOG(LogKawaiiPhysicsRecorder, Error, TEXT("Frame %d of recording %s does not match its limits"), FrameIndex, *Recording.Name);
+				return false;
+			}
+			for (auto& Planar : Node.PlanarLimits)
+			{
+				Planar.Plane = FPlane(Planar.Location, Planar.Rotation.GetUpVector());
+			}
+			for (auto& Planar : Node.PlanarLimitsData)
+			{
+				Planar.Plane = FPlane(Planar.Location, Planar.Rotation.GetUpVector());
+			}
+
+			Node.ForceFields = Frame.ForceFields;
+			Node.DeltaTime = Frame.DeltaTime;
+
+			// Same order as EvaluateSkeletalControl_AnyThread after the inputs are recorded
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			Node.UpdateSkelCompMove(Frame.ComponentTransform);
+			if (Node.bNeedWarmUp && Node.WarmUpFrames > 0)
+			{
+				Node.WarmUp(nullptr, Frame.ComponentTransform);
+				Node.bNeedWarmUp = false;
+			}
+			Node.SimulateModifyBones(nullptr, Frame.ComponentTransform);
+			OutResult.TotalCycles += FPlatformTime::Cycles64() - StartCycles;
+
+			if (Iteration == 0)
+			{
+				for (int32 i = 0; i < OutResult.NumBones; ++i)
+				{
+					const float Divergence = FVector::Dist(Node.ModifyBones[Node.ActiveModifyBoneIndices[i]].Location, Frame.OutputLocations[i]);
+					DivergenceSum += Divergence;
+					++NumDivergenceSamples;
+					if (Divergence > OutResult.MaxDivergence)
+					{
+						OutResult.MaxDivergence = Divergence;
+						OutResult.MaxDivergenceFrame = FrameIndex;
+					}
+				}
+			}
+		}
+
+		Node.PhaseTimings = nullptr;
+	}
+
+	OutResult.MeanDivergence = NumDivergenceSamples > 0 ? DivergenceSum / NumDivergenceSamples : 0.0f;
+
+	return true;
+}
+
+FString FKawaiiPhysicsRecorder::GetRecordingDir()
+{
+	return FPaths::Combine(FPaths::ProfilingDir(), TEXT("KawaiiPhysics"));
+}
@@ -5,10 +5,14 @@
 #include "BoneContainer.h"
 #include "BonePose.h"
 #include "BoneControllers/AnimNode_SkeletalControlBase.h"
+#include "KawaiiPhysicsForceFieldSubsystem.h"
 #include "AnimNode_KawaiiPhysics.generated.h"
 
 class UKawaiiPhysicsLimitsDataAsset;
 class UKawaiiPhysicsBoneConstraintsDataAsset;
+class FKawaiiPhysicsRecorder;
+struct FKawaiiPhysicsRecording;
+struct FKawaiiPhysicsPhaseTimings;
 
 UENUM()
 enum class EPlanarConstraint : uint8
@@ -194,6 +198,19 @@ public:
 	UPROPERTY()
 	bool bSkipSimulate = false;
 
+	/** Whether the bone is present in the current LOD. Dummy bones follow their parent */
+	UPROPERTY()
+	bool bActiveInLOD = true;
+	/** Nearest ancestor present in the current LOD, simulated against instead of ParentIndex */
+	UPROPERTY()
+	int32 ActiveParentIndex = -1;
+	/** Number of children present in the current LOD */
+	UPROPERTY()
+	int32 ActiveChildNum = 0;
+	/** Restart the simulation from the pose when the bone comes back with a LOD change */
+	UPROPERTY()
+	bool bResetLocation = false;
+
 public:
 
 	void UpdatePoseTransform(const FBoneContainer& BoneContainer, FCSPose<FCompactPose>& Pose, bool ResetBoneTransformWhenBoneNotFound)
@@ -428,6 +445,14 @@ public:
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ExternalForce", meta = (PinHiddenByDefault))
 	FVector Gravity = FVector::ZeroVector;
+
+	/** Apply the force fields of UKawaiiPhysicsForceFieldSubsystem that overlap the component bounds */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ExternalForce", meta = (PinHiddenByDefault))
+	bool bEnableForceFields = false;
+
+	/** Scale to apply to force field accelerations */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ExternalForce", meta = (PinHiddenByDefault, EditCondition = "bEnableForceFields"))
+	float ForceFieldScale = 1.0f;
 	
 	/** Whether or not wind is enabled for the bodies in this simulation */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Wind", meta = (PinHiddenByDefault))
@@ -437,6 +462,13 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Wind", meta = (DisplayAfter = "bEnableWind"), meta = (PinHiddenByDefault))
 	float WindScale = 1.0f;
 
+	/**
+	 *	Sweep each bone from its previous location to its new location against spherical and capsule limits.
+	 *	Prevents fast moving bones from tunneling through limits, so a lower TargetFramerate can be used safely.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Collision", meta = (PinHiddenByDefault))
+	bool bEnableContinuousLimitCollision = false;
+
 	/**
 	 *	EXPERIMENTAL. Perform sweeps for each simulating bodies to avoid collisions with the world.
 	 *	This greatly increases the cost of the physics simulation.
@@ -475,6 +507,12 @@ protected:
 #if WITH_EDITORONLY_DATA
 	UPROPERTY()
 	bool bEditing = false;
+
+	// Data assets and their revisions the *Data arrays were last generated from
+	const UKawaiiPhysicsLimitsDataAsset* AppliedLimitsDataAsset = nullptr;
+	uint32 AppliedLimitsDataAssetRevision = 0;
+	const UKawaiiPhysicsBoneConstraintsDataAsset* AppliedBoneConstraintsDataAsset = nullptr;
+	uint32 AppliedBoneConstraintsDataAssetRevision = 0;
 #endif
 
 	FVector SkelCompMoveVector;
@@ -483,8 +521,23 @@ protected:
 	float DeltaTimeOld;
 	bool bResetDynamics;
 
+	/** Force fields overlapping the component in component space. Gathered in PreUpdate */
+	TArray<FKawaiiPhysicsForceField> ForceFields;
+
+	/** Indices of ModifyBones present in the current LOD, parents before children. Rebuilt when the required bones change */
+	TArray<int32> ActiveModifyBoneIndices;
+
+	// Input recording in progress, see p.KawaiiPhysics.Record
+	TSharedPtr<FKawaiiPhysicsRecording> Recording;
+	uint64 HandledRecordingRequestFrame = 0;
+	// Accumulates the cost of each solver phase while set, used when replaying recordings
+	FKawaiiPhysicsPhaseTimings* PhaseTimings = nullptr;
+
+	friend class FKawaiiPhysicsRecorder;
+
 public:
 	FAnimNode_KawaiiPhysics();
+	virtual ~FAnimNode_KawaiiPhysics();
 
 	// FAnimNode_Base interface
 	//virtual void GatherDebugData(FNodeDebugData& DebugData) override;
@@ -536,7 +589,12 @@ protected:
 	void InitBoneConstraints();
 	void ApplyLimitsDataAsset(const FBoneContainer& RequiredBones);
 	void ApplyBoneConstraintDataAsset(const FBoneContainer& RequiredBones);
-	int32 AddModifyBone(FComponentSpacePoseContext& Output, const FBoneContainer& BoneContainer, const FReferenceSkeleton& RefSkeleton, int32 BoneIndex);
+#if WITH_EDITOR
+	bool IsLimitsDataAssetChanged() const;
+	bool IsBoneConstraintsDataAssetChanged() const;
+#endif
+	void UpdateActiveModifyBones(const FBoneContainer& BoneContainer);
+	int32 AddModifyBone(FComponentSpacePoseContext& Output, const FBoneContainer& BoneContainer, const FReferenceSkeleton& RefSkeleton, int32 BoneIndex, int32 ParentModifyBoneIndex = INDEX_NONE);
 	
 	// clone from FReferenceSkeleton::GetDirectChildBones
 	int32 CollectChildBones(const FReferenceSkeleton& RefSkeleton, int32 ParentBoneIndex, TArray<int32> & Children) const;
@@ -551,18 +609,18 @@ protected:
 	void UpdateSkelCompMove(const FTransform& ComponentTransform);
 
 	// Simulate
-	void SimulateModifyBones(FComponentSpacePoseContext& Output, const FBoneContainer& BoneContainer, FTransform& ComponentTransform);
+	void SimulateModifyBones(const USkeletalMeshComponent* SkelComp, const FTransform& ComponentTransform);
 	void Simulate(FKawaiiPhysicsModifyBone& Bone, const FSceneInterface* Scene, const FTransform& ComponentTransform, const FVector& GravityCS, const float& Exponent);
-	void AdjustByWorldCollision(FKawaiiPhysicsModifyBone& Bone, const USkeletalMeshComponent* OwningComp, const FBoneContainer& BoneContainer);
+	void AdjustByWorldCollision(FKawaiiPhysicsModifyBone& Bone, const USkeletalMeshComponent* OwningComp);
 	void AdjustBySphereCollision(FKawaiiPhysicsModifyBone& Bone, TArray<FSphericalLimit>& Limits);
 	void AdjustByCapsuleCollision(FKawaiiPhysicsModifyBone& Bone, TArray<FCapsuleLimit>& Limits);
 	void AdjustByPlanerCollision(FKawaiiPhysicsModifyBone& Bone, TArray<FPlanarLimit>& Limits);
-	void AdjustByAngleLimit(FComponentSpacePoseContext& Output, const FBoneContainer& BoneContainer, FTransform& ComponentTransform, FKawaiiPhysicsModifyBone& Bone, const FKawaiiPhysicsModifyBone& ParentBone);
+	void AdjustByAngleLimit(FKawaiiPhysicsModifyBone& Bone, const FKawaiiPhysicsModifyBone& ParentBone);
 	void AdjustByPlanarConstraint(FKawaiiPhysicsModifyBone& Bone, const FKawaiiPhysicsModifyBone& ParentBone);
 	void AdjustByBoneConstraints();
 
 	void ApplySimulateResult(FComponentSpacePoseContext& Output, const FBoneContainer& BoneContainer, TArray<FBoneTransform>& OutBoneTransforms);
-	void WarmUp(FComponentSpacePoseContext& Output, const FBoneContainer& BoneContainer, FTransform& ComponentTransform);
+	void WarmUp(const USkeletalMeshComponent* SkelComp, const FTransform& ComponentTransform);
 	
 	FVector GetWindVelocity(const FSceneInterface* Scene, const FTransform& ComponentTransform, const FKawaiiPhysicsModifyBone& Bone) const;
 };
\ No newline at end of file
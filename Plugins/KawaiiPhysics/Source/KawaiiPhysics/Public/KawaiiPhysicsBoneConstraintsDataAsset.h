@@ -69,6 +69,12 @@ public:
 
 	void UpdatePreviewBoneList();
 	virtual void PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent) override;
+
+	/** Incremented on every edit. Nodes compare it to regenerate the constraints only after the asset has changed */
+	uint32 GetRevision() const { return Revision; }
+
+private:
+	uint32 Revision = 0;
 #endif
 	
 };
\ No newline at end of file
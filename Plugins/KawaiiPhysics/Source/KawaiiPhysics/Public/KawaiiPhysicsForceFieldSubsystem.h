@@ -0,0 +1,116 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "KawaiiPhysicsForceFieldSubsystem.generated.h"
+
+UENUM(BlueprintType)
+enum class EKawaiiPhysicsForceFieldType : uint8
+{
+	/** Pushes away from Location (pulls with negative Strength) */
+	Radial,
+	/** Pushes along Direction */
+	Directional,
+	/** Swirls around the Direction axis through Location */
+	Vortex,
+};
+
+USTRUCT(BlueprintType)
+struct KAWAIIPHYSICS_API FKawaiiPhysicsForceField
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "KawaiiPhysics")
+	EKawaiiPhysicsForceFieldType Type = EKawaiiPhysicsForceFieldType::Radial;
+
+	/** Center of the field bounds in world space */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "KawaiiPhysics")
+	FVector Location = FVector::ZeroVector;
+
+	/** Force direction of Directional fields, axis of Vortex fields */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "KawaiiPhysics")
+	FVector Direction = FVector::UpVector;
+
+	/** Acceleration applied to the bones (cm/s^2) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "KawaiiPhysics")
+	float Strength = 1000.0f;
+
+	/** Radius of the field bounds. Unbounded if 0 or below */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "KawaiiPhysics")
+	float Radius = 500.0f;
+
+	/** Fade the strength linearly to zero at Radius */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "KawaiiPhysics")
+	bool bLinearFalloff = true;
+
+	/** Seconds until the field is removed automatically. Never if 0 or below */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "KawaiiPhysics")
+	float Duration = 0.0f;
+
+	/** Acceleration at Position. Position has to be in the same space as the field */
+	FVector GetAcceleration(const FVector& Position) const;
+};
+
+USTRUCT(BlueprintType)
+struct KAWAIIPHYSICS_API FKawaiiPhysicsForceFieldHandle
+{
+	GENERATED_BODY()
+
+	int32 Index = INDEX_NONE;
+	uint32 Serial = 0;
+
+	bool IsValid() const { return Index != INDEX_NONE; }
+};
+
+/**
+ * Registry of force fields affecting every KawaiiPhysics node with bEnableForceFields in the world.
+ * Fields are flattened into a compact list at most once per frame, and each node copies only the fields overlapping its component.
+ */
+UCLASS()
+class KAWAIIPHYSICS_API UKawaiiPhysicsForceFieldSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Add a force field. Keep the handle to update or remove it */
+	UFUNCTION(BlueprintCallable, Category = "Kawaii Physics")
+	FKawaiiPhysicsForceFieldHandle AddForceField(const FKawaiiPhysicsForceField& ForceField);
+
+	/** Replace the settings of a force field. The duration restarts. Returns false if the field is gone */
+	UFUNCTION(BlueprintCallable, Category = "Kawaii Physics")
+	bool UpdateForceField(const FKawaiiPhysicsForceFieldHandle& Handle, const FKawaiiPhysicsForceField& ForceField);
+
+	/** Remove a force field. Does nothing if it has already expired */
+	UFUNCTION(BlueprintCallable, Category = "Kawaii Physics")
+	void RemoveForceField(UPARAM(ref) FKawaiiPhysicsForceFieldHandle& Handle);
+
+	UFUNCTION(BlueprintPure, Category = "Kawaii Physics")
+	int32 GetNumForceFields() const { return Entries.Num(); }
+
+	/**
+	 * Append the fields overlapping Bounds to OutForceFields, transformed into the space of ComponentTransform.
+	 * Must be called from the game thread.
+	 */
+	void GatherForceFields(const FBoxSphereBounds& Bounds, const FTransform& ComponentTransform, TArray<FKawaiiPhysicsForceField>& OutForceFields);
+
+private:
+	struct FEntry
+	{
+		FKawaiiPhysicsForceField ForceField;
+		double EndTime = 0.0;
+		uint32 Serial = 0;
+	};
+
+	void FlattenForceFields();
+	double GetEndTime(const FKawaiiPhysicsForceField& ForceField) const;
+
+	TSparseArray<FEntry> Entries;
+	uint32 NextSerial = 1;
+
+	// Compact copy of the live entries, rebuilt when dirty or on a new frame to drop expired fields
+	TArray<FKawaiiPhysicsForceField> FlattenedForceFields;
+	uint64 FlattenedFrame = 0;
+	bool bDirty = true;
+};
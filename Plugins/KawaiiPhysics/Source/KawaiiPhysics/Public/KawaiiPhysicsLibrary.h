@@ -88,6 +88,13 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Kawaii Physics", meta=(BlueprintThreadSafe))
 	static float GetWindScale(const FKawaiiPhysicsReference& KawaiiPhysics);
 
+	/** Set EnableForceFields */
+	UFUNCTION(BlueprintCallable, Category = "Kawaii Physics", meta=(BlueprintThreadSafe))
+	static FKawaiiPhysicsReference SetEnableForceFields(const FKawaiiPhysicsReference& KawaiiPhysics, bool EnableForceFields);
+	/** Get EnableForceFields */
+	UFUNCTION(BlueprintPure, Category = "Kawaii Physics", meta=(BlueprintThreadSafe))
+	static bool GetEnableForceFields(const FKawaiiPhysicsReference& KawaiiPhysics);
+
 	/** Set AllowWorldCollision */
 	UFUNCTION(BlueprintCallable, Category = "Kawaii Physics", meta=(BlueprintThreadSafe))
 	static FKawaiiPhysicsReference SetAllowWorldCollision(const FKawaiiPhysicsReference& KawaiiPhysics,bool AllowWorldCollision);
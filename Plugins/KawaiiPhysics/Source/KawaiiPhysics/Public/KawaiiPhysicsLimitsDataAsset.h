@@ -171,6 +171,9 @@ public:
 	
 	void UpdateLimit(FCollisionLimitBase* Limit);
 	void Sync();
+
+	/** Incremented on every Sync. Nodes compare it to re-apply the limits only after the asset has changed */
+	uint32 GetRevision() const { return Revision; }
 	
 #endif
 
@@ -184,6 +187,9 @@ public:
 #if WITH_EDITOR
 	FOnLimitsChanged OnLimitsChanged;
 	virtual void PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent) override;
+
+private:
+	uint32 Revision = 0;
 #endif
 	
 };
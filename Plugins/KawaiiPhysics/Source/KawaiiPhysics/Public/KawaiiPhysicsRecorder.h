@@ -0,0 +1,123 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "KawaiiPhysicsForceFieldSubsystem.h"
+
+#include <atomic>
+
+struct FAnimNode_KawaiiPhysics;
+struct FComponentSpacePoseContext;
+class USkeletalMeshComponent;
+
+/** Inputs and outputs of the solver for one evaluation of a KawaiiPhysics node */
+struct KAWAIIPHYSICS_API FKawaiiPhysicsRecordedFrame
+{
+	float DeltaTime = 0.0f;
+	FTransform ComponentTransform;
+
+	// Pose of each active modify bone, in ActiveModifyBoneIndices order
+	TArray<FVector> PoseLocations;
+	TArray<FQuat> PoseRotations;
+	TArray<FVector> PoseScales;
+
+	// Every limit in the order SphericalLimits, SphericalLimitsData, CapsuleLimits, CapsuleLimitsData, PlanarLimits, PlanarLimitsData
+	TArray<FVector> LimitLocations;
+	TArray<FQuat> LimitRotations;
+	TArray<bool> LimitEnables;
+
+	// In component space, as gathered in PreUpdate
+	TArray<FKawaiiPhysicsForceField> ForceFields;
+
+	// Simulated location of each active modify bone
+	TArray<FVector> OutputLocations;
+
+	friend FArchive& operator<<(FArchive& Ar, FKawaiiPhysicsRecordedFrame& Frame);
+};
+
+/** Solver inputs of one node over consecutive frames, replayable without a world or skeletal mesh */
+struct KAWAIIPHYSICS_API FKawaiiPhysicsRecording
+{
+	static constexpr uint32 FileMagic = 0x4B505243;
+	static constexpr uint32 FileVersion = 1;
+
+	FString Name;
+
+	// Tagged properties of the node, including the modify bones and limits, before the first frame
+	TArray<uint8> NodeData;
+	TArray<int32> ActiveModifyBoneIndices;
+	float DeltaTimeOld = 0.0f;
+
+	TArray<FKawaiiPhysicsRecordedFrame> Frames;
+
+	// Not serialized. Component whose node records, the recording is saved by the recorder once the component is gone
+	TWeakObjectPtr<const USkeletalMeshComponent> SkelComp;
+	// Not serialized. FPlatformTime::Seconds of the last recorded frame, a recording whose node stopped evaluating for p.KawaiiPhysics.RecordTimeout is saved by the recorder
+	std::atomic<double> LastRecordTime{0.0};
+	// Not serialized. Set once the recording was handed over for saving, the node stops appending frames
+	std::atomic<bool> bFinished{false};
+
+	bool SaveToFile(const FString& Filename) const;
+	bool LoadFromFile(const FString& Filename);
+
+	friend FArchive& operator<<(FArchive& Ar, FKawaiiPhysicsRecording& Recording);
+};
+
+/** Cycles spent in each phase of FAnimNode_KawaiiPhysics::SimulateModifyBones */
+struct KAWAIIPHYSICS_API FKawaiiPhysicsPhaseTimings
+{
+	uint64 SimulateCycles = 0;
+	uint64 BoneConstraintCycles = 0;
+	uint64 CollisionCycles = 0;
+	uint64 AdjustCycles = 0;
+};
+
+struct KAWAIIPHYSICS_API FKawaiiPhysicsReplayResult
+{
+	int32 NumFrames = 0;
+	int32 NumBones = 0;
+	int32 NumIterations = 0;
+
+	// Summed over all iterations
+	FKawaiiPhysicsPhaseTimings PhaseTimings;
+	uint64 TotalCycles = 0;
+
+	// Distance between the replayed and the recorded bone locations
+	float MaxDivergence = 0.0f;
+	float MeanDivergence = 0.0f;
+	int32 MaxDivergenceFrame = INDEX_NONE;
+};
+
+/**
+ * Records the solver inputs of KawaiiPhysics nodes to files and replays them headlessly.
+ * Run "p.KawaiiPhysics.Record" to record the next p.KawaiiPhysics.RecordFrames frames of every evaluated node
+ * into Saved/Profiling/KawaiiPhysics, then replay the files with the KawaiiPhysicsReplay commandlet.
+ * World collision and wind need the world and are skipped in replays, and node properties are only captured on the first frame.
+ * Finished recordings are written on a background thread so the parallel animation evaluation is not stalled by disk writes.
+ * Recordings of nodes which are destroyed, whose component is destroyed or which stop evaluating for p.KawaiiPhysics.RecordTimeout seconds
+ * are saved with the frames recorded so far. Nodes skipping frames, e.g. because of URO or while offscreen, keep their recording.
+ */
+class KAWAIIPHYSICS_API FKawaiiPhysicsRecorder
+{
+public:
+	/** Called before the solver runs. Returns true if the frame is being recorded */
+	static bool RecordInputs(FAnimNode_KawaiiPhysics& Node, const FComponentSpacePoseContext& Output, const FTransform& ComponentTransform);
+	/** Called after the solver ran on a recorded frame */
+	static void RecordOutputs(FAnimNode_KawaiiPhysics& Node);
+	/** Stop the recording of Node, if any, and save it in the background */
+	static void FinishRecording(FAnimNode_KawaiiPhysics& Node);
+
+	/** Run the recorded frames through the solver NumIterations times, measuring each phase */
+	static bool Replay(const FKawaiiPhysicsRecording& Recording, int32 NumIterations, FKawaiiPhysicsReplayResult& OutResult);
+
+	static FString GetRecordingDir();
+
+private:
+	/** Hands a recording over to a background thread which writes it to the recording directory */
+	static void SaveRecordingAsync(const TSharedPtr<FKawaiiPhysicsRecording>& Recording);
+	/** Keeps track of a new recording so it is saved if its node stops evaluating */
+	static void AddActiveRecording(const TSharedPtr<FKawaiiPhysicsRecording>& Recording);
+	/** Saves the recordings whose component is gone or whose node timed out, runs on the core ticker between frames */
+	static bool SaveStaleRecordings(float DeltaTime);
+};
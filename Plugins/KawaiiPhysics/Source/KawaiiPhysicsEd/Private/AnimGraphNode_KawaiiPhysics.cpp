@@ -74,6 +74,11 @@ void UAnimGraphNode_KawaiiPhysics::Draw(FPrimitiveDrawInterface* PDI, USkeletalM
 	{
 		for (auto& Bone : ActiveNode->ModifyBones)
 		{
+			if (!Bone.bActiveInLOD)
+			{
+				continue;
+			}
+
 			PDI->DrawPoint(Bone.Location, FLinearColor::White, 5.0f, SDPG_Foreground);
 
 			if (Bone.PhysicsSettings.Radius > 0)
@@ -84,6 +89,10 @@ void UAnimGraphNode_KawaiiPhysics::Draw(FPrimitiveDrawInterface* PDI, USkeletalM
 
 			for (const int32 ChildIndex : Bone.ChildIndexs)
 			{
+				if (!ActiveNode->ModifyBones[ChildIndex].bActiveInLOD)
+				{
+					continue;
+				}
 				DrawDashedLine(PDI, Bone.Location, ActiveNode->ModifyBones[ChildIndex].Location,
 					FLinearColor::White, 1, SDPG_Foreground);
 			}
@@ -94,12 +103,12 @@ void UAnimGraphNode_KawaiiPhysics::Draw(FPrimitiveDrawInterface* PDI, USkeletalM
 	{
 		for (auto& Bone : ActiveNode->ModifyBones)
 		{
-			if (Bone.ParentIndex < 0 || Bone.PhysicsSettings.LimitAngle <= 0)
+			if (!Bone.bActiveInLOD || Bone.ActiveParentIndex < 0 || Bone.PhysicsSettings.LimitAngle <= 0)
 			{
 				continue;
 			}
 
-			auto& ParentBone = ActiveNode->ModifyBones[Bone.ParentIndex];
+			auto& ParentBone = ActiveNode->ModifyBones[Bone.ActiveParentIndex];
 			FTransform ParentBoneTransform =
 				FTransform(FQuat::FindBetween(FVector::ForwardVector, Bone.PoseLocation - ParentBone.PoseLocation), ParentBone.Location);
 			TArray<FVector> Verts;
@@ -162,6 +171,8 @@ void UAnimGraphNode_KawaiiPhysics::CopyNodeDataToPreviewNode(FAnimNode_Base* Ani
 
 	// ExternalForce
 	KawaiiPhysics->Gravity = Node.Gravity;
+	KawaiiPhysics->bEnableForceFields = Node.bEnableForceFields;
+	KawaiiPhysics->ForceFieldScale = Node.ForceFieldScale;
 
 	// Wind
 	KawaiiPhysics->bEnableWind = Node.bEnableWind;
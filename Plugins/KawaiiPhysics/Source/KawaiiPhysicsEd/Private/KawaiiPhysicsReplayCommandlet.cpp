@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "KawaiiPhysicsReplayCommandlet.h"
+
+#include "HAL/FileManager.h"
+#include "KawaiiPhysicsRecorder.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogKawaiiPhysicsReplay, Log, All);
+
+UKawaiiPhysicsReplayCommandlet::UKawaiiPhysicsReplayCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 UKawaiiPhysicsReplayCommandlet::Main(const FString& Params)
+{
+	FString File;
+	int32 Iterations = 10;
+	float Tolerance = -1.0f;
+	FParse::Value(*Params, TEXT("File="), File);
+	FParse::Value(*Params, TEXT("Iterations="), Iterations);
+	FParse::Value(*Params, TEXT("Tolerance="), Tolerance);
+
+	TArray<FString> Files;
+	if (!File.IsEmpty())
+	{
+		Files.Add(File);
+	}
+	else
+	{
+		const FString RecordingDir = FKawaiiPhysicsRecorder::GetRecordingDir();
+		IFileManager::Get().FindFiles(Files, *FPaths::Combine(RecordingDir, TEXT("*.kprec")), true, false);
+		for (FString& FoundFile : Files)
+		{
+			FoundFile = FPaths::Combine(RecordingDir, FoundFile);
+		}
+	}
+
+	if (Files.Num() == 0)
+	{
+		UE_LOG(LogKawaiiPhysicsReplay, Error, TEXT("No recordings found. Record with p.KawaiiPhysics.Record or pass -File="));
+		return 1;
+	}
+
+	int32 Result = 0;
+	for (const FString& Filename : Files)
+	{
+		FKawaiiPhysicsRecording Recording;
+		if (!Recording.LoadFromFile(Filename))
+		{
+			UE_LOG(LogKawaiiPhysicsReplay, Error, TEXT("Failed to load %s"), *Filename);
+			Result = 1;
+			continue;
+		}
+
+		FKawaiiPhysicsReplayResult ReplayResult;
+		if (!FKawaiiPhysicsRecorder::Replay(Recording, Iterations, ReplayResult))
+		{
+			Result = 1;
+			continue;
+		}
+
+		// Average milliseconds per replayed frame
+		const double NumSteps = FMath::Max(ReplayResult.NumFrames * ReplayResult.NumIterations, 1);
+		auto ToMs = [NumSteps](uint64 Cycles)
+		{
+			return FPlatformTime::ToMilliseconds64(Cycles) / NumSteps;
+		};
+
+		UE_LOG(LogKawaiiPhysicsReplay, Display, TEXT("%s: %d frames, %d bones, %d iterations"),
+			*Recording.Name, ReplayResult.NumFrames, ReplayResult.NumBones, ReplayResult.NumIterations);
+		UE_LOG(LogKawaiiPhysicsReplay, Display, TEXT("  Total %.4f ms/frame (Simulate %.4f, BoneConstraint %.4f, Collision %.4f, Adjust %.4f)"),
+			ToMs(ReplayResult.TotalCycles), ToMs(ReplayResult.PhaseTimings.SimulateCycles), ToMs(ReplayResult.PhaseTimings.BoneConstraintCycles),
+			ToMs(ReplayResult.PhaseTimings.CollisionCycles), ToMs(ReplayResult.PhaseTimings.AdjustCycles));
+		UE_LOG(LogKawaiiPhysicsReplay, Display, TEXT("  Divergence max %.4f cm (frame %d), mean %.4f cm"),
+			ReplayResult.MaxDivergence, ReplayResult.MaxDivergenceFrame, ReplayResult.MeanDivergence);
+
+		if (Tolerance >= 0.0f && ReplayResult.MaxDivergence > Tolerance)
+		{
+			UE_LOG(LogKawaiiPhysicsReplay, Error, TEXT("%s diverged more than %.4f cm"), *Recording.Name, Tolerance);
+			Result = 1;
+		}
+	}
+
+	return Result;
+}
@@ -0,0 +1,23 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "KawaiiPhysicsReplayCommandlet.generated.h"
+
+/**
+ * Replays KawaiiPhysics recordings (see p.KawaiiPhysics.Record) through the solver and reports phase timings and divergence.
+ * Needs no GPU: UnrealEditor-Cmd <Project> -run=KawaiiPhysicsReplay [-File=<.kprec>] [-Iterations=<N>] [-Tolerance=<cm>] -nullrhi
+ * Without -File, every recording in Saved/Profiling/KawaiiPhysics is replayed. Fails if a replay diverges more than -Tolerance.
+ */
+UCLASS()
+class UKawaiiPhysicsReplayCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UKawaiiPhysicsReplayCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
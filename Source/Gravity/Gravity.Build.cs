@@ -17,7 +17,8 @@ public class Gravity : ModuleRules
             "CoreUObject",
 			"Engine",
 			"InputCore",
-            "PhysicsCore"
+            "PhysicsCore",
+			"Chaos"
         });
 	}
 }
@@ -1,115 +1,368 @@
 #include "Breakables/BreakableActorInterface.h"
 
-#include <AssetRegistry/AssetRegistryModule.h>
 #include <PhysicalMaterials/PhysicalMaterial.h>
-#include <Modules/ModuleManager.h>
+#include <HAL/IConsoleManager.h>
+#include <Algo/BinarySearch.h>
 
-#include "Breakables/DebrisStaticMeshComponent.h"
-#include "Breakables/DebrisStaticMeshActor.h"
+#if WITH_EDITOR
+#include <EngineUtils.h>
+#endif
+
+#include "Breakables/BreakableFractureData.h"
+#include "Subsystems/BreakableGrid.h"
+#include "Subsystems/BreakableSubsystem.h"
+#include "Subsystems/DebrisSubsystem.h"
 
 DEFINE_LOG_CATEGORY(LogGravityBreakableObject)
 
+DECLARE_CYCLE_STAT(TEXT("Notify Hit"), STAT_BreakableNotifyHit, STATGROUP_Breakables);
+DECLARE_CYCLE_STAT(TEXT("On Break Actor"), STAT_BreakableOnBreakActor, STATGROUP_Breakables);
+DECLARE_CYCLE_STAT(TEXT("On Spawn Debris"), STAT_BreakableOnSpawnDebris, STATGROUP_Breakables);
+
+static TAutoConsoleVariable<float> CVarDebrisLODDistanceScale(
+	TEXT("gravity.Debris.LODDistanceScale"),
+	1.0f,
+	TEXT("Scales the debris LOD distances of all breakables, lower values reduce the debris on weaker platforms."),
+	ECVF_Scalability);
+
 ABreakableActorInterface::ABreakableActorInterface()
-	: BreakThreshold(100.0f)
+	: BreakThreshold(50000.0f)
+	, DamageThreshold(10000.0f)
 	, bIsBreakable(true)
 	, DebrisLifetime(5.0f)
 	, DebrisDespawnDuration(2.0f)
+	, DebrisReducedDistance(2000.0f)
+	, DebrisCosmeticDistance(4000.0f)
+	, DebrisCullDistance(8000.0f)
+	, DebrisReducedFraction(0.5f)
+	, bPropagateBreaks(false)
+	, SupportTolerance(5.0f)
 {
 	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("BreakableActorInterface_RootComponent"));
 }
 
+void ABreakableActorInterface::BeginPlay()
+{
+	Super::BeginPlay();
+
+	UBreakableSubsystem* breakableSubsystem = GetWorld()->GetSubsystem<UBreakableSubsystem>();
+
+	// restore the breaks from before the actor was streamed out
+	if (breakableSubsystem)
+	{
+		if (const TBitArray<>* brokenItems = breakableSubsystem->FindBrokenState(GetActorInstanceGuid()))
+		{
+			ApplyBrokenState(*brokenItems);
+		}
+	}
+
+	// a breakable which is completely broken can destroy itself while its state is applied
+	if (IsActorBeingDestroyed())
+	{
+		return;
+	}
+
+	// the debris meshes are streamed in when the player comes close
+	if (UDebrisSubsystem* debrisSubsystem = GetWorld()->GetSubsystem<UDebrisSubsystem>())
+	{
+		debrisSubsystem->RegisterBreakable(this);
+	}
+
+	if (breakableSubsystem)
+	{
+		breakableSubsystem->RegisterBreakable(this);
+	}
+}
+
+void ABreakableActorInterface::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UDebrisSubsystem* debrisSubsystem = GetWorld()->GetSubsystem<UDebrisSubsystem>())
+	{
+		debrisSubsystem->UnregisterBreakable(this);
+	}
+
+	if (UBreakableSubsystem* breakableSubsystem = GetWorld()->GetSubsystem<UBreakableSubsystem>())
+	{
+		breakableSubsystem->UnregisterBreakable(this);
+
+		// the actor is loaded again from its package when its cell streams in, the breaks are kept in the subsystem until then
+		if (EndPlayReason == EEndPlayReason::RemovedFromWorld || EndPlayReason == EEndPlayReason::Destroyed)
+		{
+			TBitArray<> brokenItems;
+
+			if (GetBrokenState(brokenItems))
+			{
+				breakableSubsystem->StoreBrokenState(GetActorInstanceGuid(), MoveTemp(brokenItems));
+			}
+		}
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
 void ABreakableActorInterface::NotifyHit(UPrimitiveComponent* MyComp, AActor* Other, UPrimitiveComponent* OtherComp, bool bSelfMoved, FVector HitLocation, FVector HitNormal, FVector NormalImpulse, const FHitResult& Hit)
 {
+	SCOPE_CYCLE_COUNTER(STAT_BreakableNotifyHit);
+	CSV_SCOPED_TIMING_STAT(Breakables, NotifyHit);
+
 	// notify subsystems about the hit before modifying the hit actor
 	Super::NotifyHit(MyComp, Other, OtherComp, bSelfMoved, HitLocation, HitNormal, NormalImpulse, Hit);
 
-	FActorBreakResult actorBreakResult = OnBreakActor(MyComp, OtherComp, Hit);
+	// most hits are resting or sliding contacts, they are rejected before the break evaluation
+	if (!bIsBreakable || NormalImpulse.SizeSquared() < FMath::Square(DamageThreshold))
+	{
+		return;
+	}
+
+	// the hits of a frame are coalesced and evaluated in one pass after physics
+	if (UBreakableSubsystem* breakableSubsystem = GetWorld()->GetSubsystem<UBreakableSubsystem>())
+	{
+		breakableSubsystem->QueueHit(this, MyComp, OtherComp, NormalImpulse, Hit);
+	}
+	else
+	{
+		ProcessHit(MyComp, OtherComp, NormalImpulse, Hit);
+	}
+}
+
+bool ABreakableActorInterface::ProcessHit(UPrimitiveComponent* MyComponent, UPrimitiveComponent* OtherComponent, const FVector& NormalImpulse, const FHitResult& Hit)
+{
+	// the actor could have been made unbreakable since the hit was queued
+	if (!bIsBreakable)
+	{
+		return false;
+	}
+
+	FActorBreakResult actorBreakResult;
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_BreakableOnBreakActor);
+		CSV_SCOPED_TIMING_STAT(Breakables, OnBreakActor);
+
+		actorBreakResult = OnBreakActor(MyComponent, OtherComponent, NormalImpulse, Hit);
+	}
 
 	OnPostBreakActor(actorBreakResult);
+
+	return actorBreakResult.bIsBroken;
 }
 
-void ABreakableActorInterface::OnSpawnDebris(const FTransform& RelativeTransform)
+bool ABreakableActorInterface::ApplyImpulseDamage(float& InOutDamage, const FVector& NormalImpulse) const
 {
-	// @todo: optimize the spawn routine, the current one leads to stuttering.
-	FActorSpawnParameters actorSpawnParameters;
+	const float impulse = NormalImpulse.Size();
 
-	actorSpawnParameters.CustomPreSpawnInitalization = [this](AActor* SpawnedActor)
+	if (impulse >= DamageThreshold)
 	{
-		ADebrisStaticMeshActor* debrisActor = Cast<ADebrisStaticMeshActor>(SpawnedActor);
+		InOutDamage += impulse;
+	}
 
-		for (const auto& staticMesh : DebrisStaticMeshes)
-		{
-			if (staticMesh)
-			{
-				UDebrisStaticMeshComponent* debrisComponent = debrisActor->AddDebris();
+	return InOutDamage >= BreakThreshold;
+}
 
-				debrisComponent->SetStaticMesh(staticMesh);
-				debrisComponent->SetDebrisLifetime(DebrisLifetime);
-				debrisComponent->SetDebrisDespawnDuration(DebrisDespawnDuration);
+void ABreakableActorInterface::OnSpawnDebris(const FTransform& RelativeTransform, const FVector& LinearVelocity)
+{
+	SCOPE_CYCLE_COUNTER(STAT_BreakableOnSpawnDebris);
+	CSV_SCOPED_TIMING_STAT(Breakables, OnSpawnDebris);
 
-				if (DebrisPhysicalMaterial)
-				{
-					debrisComponent->SetPhysMaterialOverride(DebrisPhysicalMaterial);
-				}
-			}
-		}
-	};
+	UDebrisSubsystem* debrisSubsystem = GetWorld()->GetSubsystem<UDebrisSubsystem>();
+
+	if (!debrisSubsystem)
+	{
+		return;
+	}
+
+	// the generic debris is spawned if the break happens before the debris meshes finished streaming
+	const UBreakableFractureData* fractureData = FractureData && FractureData->AreStaticMeshesLoaded() ? FractureData.Get() : debrisSubsystem->GetFallbackFractureData();
+
+	if (!fractureData)
+	{
+		return;
+	}
+
+	const FTransform debrisTransform = RelativeTransform * GetActorTransform();
+	const EBreakableDebrisLOD debrisLOD = GetDebrisLOD(debrisTransform.GetLocation());
+
+	if (debrisLOD == EBreakableDebrisLOD::None)
+	{
+		return;
+	}
+
+	// the debris actors and their physics bodies are taken from the pool, nothing is spawned here unless the pool is exhausted.
+	// the spawn is queued so many breaks in the same frame are spread over several frames.
+	FDebrisSpawnParameters debrisSpawnParameters;
+
+	const TArray<FBreakableFracturePiece>& fracturePieces = fractureData->GetPieces();
+	const TArray<TObjectPtr<UStaticMesh>>& fractureStaticMeshes = fractureData->GetLoadedStaticMeshes();
+
+	TArray<int32, TInlineAllocator<32>> pieceIndices;
+	pieceIndices.SetNumUninitialized(fractureStaticMeshes.Num());
+
+	for (int32 pieceIndex = 0; pieceIndex < pieceIndices.Num(); ++pieceIndex)
+	{
+		pieceIndices[pieceIndex] = pieceIndex;
+	}
+
+	// the heaviest pieces carry the silhouette of the break
+	if (debrisLOD == EBreakableDebrisLOD::Reduced)
+	{
+		pieceIndices.Sort([&fracturePieces](int32 A, int32 B) { return fracturePieces[A].Mass > fracturePieces[B].Mass; });
+		pieceIndices.SetNum(FMath::CeilToInt32(pieceIndices.Num() * DebrisReducedFraction));
+	}
+
+	debrisSpawnParameters.Pieces.Reserve(pieceIndices.Num());
+
+	for (const int32 pieceIndex : pieceIndices)
+	{
+		FDebrisPieceParameters& debrisPiece = debrisSpawnParameters.Pieces.AddDefaulted_GetRef();
+		debrisPiece.StaticMesh = fractureStaticMeshes[pieceIndex];
+		debrisPiece.RelativeTransform = fracturePieces[pieceIndex].RelativeTransform;
+		debrisPiece.Mass = fracturePieces[pieceIndex].Mass;
+		debrisPiece.BodySetup = fracturePieces[pieceIndex].BodySetup;
+	}
+
+	debrisSpawnParameters.PhysicalMaterial = DebrisPhysicalMaterial;
+	debrisSpawnParameters.Transform = debrisTransform;
+	debrisSpawnParameters.LinearVelocity = LinearVelocity;
+	debrisSpawnParameters.Lifetime = DebrisLifetime;
+	debrisSpawnParameters.DespawnDuration = DebrisDespawnDuration;
+	debrisSpawnParameters.bIsCosmetic = debrisLOD == EBreakableDebrisLOD::Cosmetic;
+
+	debrisSubsystem->QueueDebris(debrisSpawnParameters);
+}
 
-	FTransform actorWorldTransform = RelativeTransform * GetActorTransform();
+EBreakableDebrisLOD ABreakableActorInterface::GetDebrisLOD(const FVector& Location) const
+{
+	const UDebrisSubsystem* debrisSubsystem = GetWorld()->GetSubsystem<UDebrisSubsystem>();
+
+	FVector viewLocation;
+
+	if (!debrisSubsystem || !debrisSubsystem->GetViewLocation(viewLocation))
+	{
+		return EBreakableDebrisLOD::Full;
+	}
+
+	const float distanceScale = FMath::Max(CVarDebrisLODDistanceScale.GetValueOnGameThread(), 0.0f);
+	const double distanceSquared = FVector::DistSquared(viewLocation, Location);
+
+	if (distanceSquared >= FMath::Square(DebrisCullDistance * distanceScale))
+	{
+		return EBreakableDebrisLOD::None;
+	}
+	else if (distanceSquared >= FMath::Square(DebrisCosmeticDistance * distanceScale))
+	{
+		return EBreakableDebrisLOD::Cosmetic;
+	}
+	else if (distanceSquared >= FMath::Square(DebrisReducedDistance * distanceScale))
+	{
+		return EBreakableDebrisLOD::Reduced;
+	}
 
-	GetWorld()->SpawnActor<ADebrisStaticMeshActor>(ADebrisStaticMeshActor::StaticClass(), actorWorldTransform, actorSpawnParameters);
+	return EBreakableDebrisLOD::Full;
 }
 
 void ABreakableActorInterface::OnPostBreakActor(const FActorBreakResult& BreakResult)
 {
 	if (BreakResult.bIsBroken)
 	{
-		OnSpawnDebris(BreakResult.DebrisTransform);
+		// broken items are no longer affected by area-of-effect breaks
+		if (UBreakableSubsystem* breakableSubsystem = GetWorld()->GetSubsystem<UBreakableSubsystem>())
+		{
+			breakableSubsystem->NotifyItemBroken(this, BreakResult.BrokenItem);
+		}
+
+		if (bPropagateBreaks)
+		{
+			QueueSupportedBreaks(BreakResult.BrokenItem);
+		}
+
+		OnSpawnDebris(BreakResult.DebrisTransform, BreakResult.DebrisLinearVelocity);
+	}
+}
+
+void ABreakableActorInterface::QueueSupportedBreaks(int32 Item)
+{
+	UBreakableSubsystem* breakableSubsystem = GetWorld()->GetSubsystem<UBreakableSubsystem>();
+
+	if (!breakableSubsystem)
+	{
+		return;
+	}
+
+	for (int32 linkIndex = Algo::LowerBoundBy(SupportLinks, Item, &FBreakableSupportLink::SourceItem); linkIndex < SupportLinks.Num() && SupportLinks[linkIndex].SourceItem == Item; ++linkIndex)
+	{
+		// targets in cells which are not loaded are skipped
+		if (ABreakableActorInterface* target = SupportLinks[linkIndex].Target.Get())
+		{
+			breakableSubsystem->QueueSupportedBreak(target, SupportLinks[linkIndex].TargetItem);
+		}
 	}
 }
 
 #if WITH_EDITOR
-void ABreakableActorInterface::PostEditChangeChainProperty(FPropertyChangedChainEvent& PropertyChangedEvent)
+void ABreakableActorInterface::BakeSupportLinks()
 {
-	const auto* activeMemberNode = PropertyChangedEvent.PropertyChain.GetActiveMemberNode();
+	Modify();
+
+	SupportLinks.Reset();
+
+	TArray<FBreakableItem> sourceItems;
+	GetBreakableItems(sourceItems);
 
-	if (activeMemberNode)
+	TArray<TPair<ABreakableActorInterface*, FBreakableItem>> targetItems;
+	FBreakableGrid targetGrid;
+
+	for (TActorIterator<ABreakableActorInterface> breakableIt(GetWorld()); breakableIt; ++breakableIt)
 	{
-		FName memberPropertyName = activeMemberNode->GetValue()->GetFName();
+		TArray<FBreakableItem> breakableItems;
+		breakableIt->GetBreakableItems(breakableItems);
 
-		if (memberPropertyName == GET_MEMBER_NAME_CHECKED(ABreakableActorInterface, DebrisStaticMeshDir))
+		for (const FBreakableItem& breakableItem : breakableItems)
 		{
-			DebrisStaticMeshes.Reset();
+			targetGrid.Add(targetItems.Num(), breakableItem.Bounds.Center, static_cast<float>(breakableItem.Bounds.W));
+			targetItems.Emplace(*breakableIt, breakableItem);
+		}
+	}
 
-			if (!DebrisStaticMeshDir.Path.IsEmpty())
-			{
-				FAssetRegistryModule& AssetRegistryModule = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry"));
+	TArray<int32> overlappingItems;
 
-				FARFilter assetRegistryFilter;
-				assetRegistryFilter.ClassPaths.Add(UStaticMesh::StaticClass()->GetClassPathName());
-				assetRegistryFilter.PackagePaths.Add(*DebrisStaticMeshDir.Path);
+	for (const FBreakableItem& sourceItem : sourceItems)
+	{
+		const FBox& sourceBox = sourceItem.Box;
 
-				TArray<FAssetData> assetData;
+		overlappingItems.Reset();
+		targetGrid.Query(sourceBox.ExpandBy(SupportTolerance), overlappingItems);
 
-				AssetRegistryModule.Get().GetAssets(assetRegistryFilter, assetData);
+		for (const int32 targetIndex : overlappingItems)
+		{
+			const TPair<ABreakableActorInterface*, FBreakableItem>& targetItem = targetItems[targetIndex];
+			const FBox& targetBox = targetItem.Value.Box;
 
-				for (const FAssetData& asset : assetData)
-				{
-					UStaticMesh* debrisMesh = Cast<UStaticMesh>(asset.GetAsset());
+			if (targetItem.Key == this && targetItem.Value.Item == sourceItem.Item)
+			{
+				continue;
+			}
+
+			// only the items resting on the source are supported by it, items next to it only touch its sides
+			if (targetBox.Min.X >= sourceBox.Max.X || targetBox.Max.X <= sourceBox.Min.X ||
+				targetBox.Min.Y >= sourceBox.Max.Y || targetBox.Max.Y <= sourceBox.Min.Y)
+			{
+				continue;
+			}
 
-					if (debrisMesh)
-					{
-						DebrisStaticMeshes.Add(debrisMesh);
-					}
-					else
-					{
-						UE_LOG(LogGravityBreakableObject, Warning, TEXT("Breakable actor '%s' failed to load debris mesh '%s'."), *GetName(), *asset.AssetName.ToString());
-					}
-				}
+			if (FMath::Abs(targetBox.Min.Z - sourceBox.Max.Z) > SupportTolerance)
+			{
+				continue;
 			}
+
+			FBreakableSupportLink& supportLink = SupportLinks.AddDefaulted_GetRef();
+			supportLink.SourceItem = sourceItem.Item;
+			supportLink.Target = targetItem.Key;
+			supportLink.TargetItem = targetItem.Value.Item;
 		}
 	}
 
-	Super::PostEditChangeChainProperty(PropertyChangedEvent);
+	SupportLinks.StableSort([](const FBreakableSupportLink& A, const FBreakableSupportLink& B) { return A.SourceItem < B.SourceItem; });
+
+	UE_LOG(LogGravityBreakableObject, Display, TEXT("Breakable '%s' baked %d support links."), *GetActorNameOrLabel(), SupportLinks.Num());
 }
 #endif // WITH_EDITOR
\ No newline at end of file
@@ -0,0 +1,242 @@
+#include "Breakables/BreakableFractureData.h"
+
+#include <Engine/StaticMesh.h>
+#include <PhysicsEngine/BodySetup.h>
+
+#if WITH_EDITOR
+#include <StaticMeshResources.h>
+#include <StaticMeshCompiler.h>
+#include <AssetRegistry/AssetRegistryModule.h>
+#include <Modules/ModuleManager.h>
+#endif
+
+#include "Breakables/BreakableActorInterface.h"
+
+UBreakableFractureData::UBreakableFractureData()
+	: Density(1.0f)
+	, CollisionShape(EBreakableCollisionShape::Convex)
+	, MaxConvexVertices(32)
+{
+}
+
+void UBreakableFractureData::LoadStaticMeshes()
+{
+	LoadedStaticMeshes.SetNum(Pieces.Num());
+
+	for (int32 pieceIndex = 0; pieceIndex < Pieces.Num(); ++pieceIndex)
+	{
+		if (!LoadedStaticMeshes[pieceIndex])
+		{
+			LoadedStaticMeshes[pieceIndex] = Pieces[pieceIndex].StaticMesh.LoadSynchronous();
+		}
+	}
+}
+
+void UBreakableFractureData::GetStaticMeshPaths(TArray<FSoftObjectPath>& OutPaths) const
+{
+	OutPaths.Reserve(OutPaths.Num() + Pieces.Num());
+
+	for (const FBreakableFracturePiece& piece : Pieces)
+	{
+		if (!piece.StaticMesh.IsNull())
+		{
+			OutPaths.Add(piece.StaticMesh.ToSoftObjectPath());
+		}
+	}
+}
+
+void UBreakableFractureData::ResolveStaticMeshes()
+{
+	LoadedStaticMeshes.SetNum(Pieces.Num());
+
+	for (int32 pieceIndex = 0; pieceIndex < Pieces.Num(); ++pieceIndex)
+	{
+		LoadedStaticMeshes[pieceIndex] = Pieces[pieceIndex].StaticMesh.Get();
+	}
+}
+
+void UBreakableFractureData::ReleaseStaticMeshes()
+{
+	LoadedStaticMeshes.Reset();
+}
+
+#if WITH_EDITOR
+void UBreakableFractureData::Bake()
+{
+	TArray<FBreakableFracturePiece> previousPieces = MoveTemp(Pieces);
+
+	Pieces.Reset();
+	LoadedStaticMeshes.Reset();
+
+	if (SourceMeshDir.Path.IsEmpty())
+	{
+		return;
+	}
+
+	FAssetRegistryModule& AssetRegistryModule = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry"));
+
+	FARFilter assetRegistryFilter;
+	assetRegistryFilter.ClassPaths.Add(UStaticMesh::StaticClass()->GetClassPathName());
+	assetRegistryFilter.PackagePaths.Add(*SourceMeshDir.Path);
+
+	TArray<FAssetData> assetData;
+
+	AssetRegistryModule.Get().GetAssets(assetRegistryFilter, assetData);
+
+	for (const FAssetData& asset : assetData)
+	{
+		UStaticMesh* debrisMesh = Cast<UStaticMesh>(asset.GetAsset());
+
+		if (!debrisMesh)
+		{
+			UE_LOG(LogGravityBreakableObject, Warning, TEXT("Fracture data '%s' failed to load debris mesh '%s'."), *GetName(), *asset.AssetName.ToString());
+			continue;
+		}
+
+		// the bounds and the render data are only valid once the mesh is compiled
+		FStaticMeshCompilingManager::Get().FinishCompilation({ debrisMesh });
+
+		FBreakableFracturePiece& piece = Pieces.AddDefaulted_GetRef();
+		piece.StaticMesh = debrisMesh;
+		piece.Bounds = debrisMesh->GetBoundingBox();
+
+		// fractured meshes usually share the pivot of the intact mesh, in this case the identity is the right pose.
+		// poses edited by hand survive a rebake.
+		const FBreakableFracturePiece* previousPiece = previousPieces.FindByPredicate([debrisMesh](const FBreakableFracturePiece& Piece) { return Piece.StaticMesh == debrisMesh; });
+
+		if (previousPiece)
+		{
+			piece.RelativeTransform = previousPiece->RelativeTransform;
+		}
+
+		piece.BodySetup = BakeBodySetup(debrisMesh, previousPiece ? previousPiece->BodySetup.Get() : nullptr);
+
+		// the collision volume is more accurate than the bounds
+		const FVector boundsSize = piece.Bounds.GetSize();
+
+		float volume = piece.BodySetup->AggGeom.GetScaledVolume(FVector::OneVector);
+
+		if (volume <= 0.0f)
+		{
+			volume = boundsSize.X * boundsSize.Y * boundsSize.Z;
+		}
+
+		piece.Mass = volume * Density * 0.001f;
+
+		const FVector boundsSizeSquared = boundsSize * boundsSize;
+		piece.InertiaTensor = piece.Mass / 12.0f * FVector(
+			boundsSizeSquared.Y + boundsSizeSquared.Z,
+			boundsSizeSquared.X + boundsSizeSquared.Z,
+			boundsSizeSquared.X + boundsSizeSquared.Y);
+	}
+
+	UE_LOG(LogGravityBreakableObject, Display, TEXT("Fracture data '%s' baked %d pieces."), *GetName(), Pieces.Num());
+
+	MarkPackageDirty();
+}
+
+UBodySetup* UBreakableFractureData::BakeBodySetup(const UStaticMesh* StaticMesh, UBodySetup* PreviousBodySetup)
+{
+	UBodySetup* bodySetup = PreviousBodySetup ? PreviousBodySetup : NewObject<UBodySetup>(this, NAME_None, RF_Transactional);
+
+	bodySetup->Modify();
+	bodySetup->RemoveSimpleCollision();
+
+	// debris never needs per-triangle queries, traces use the simple shape as well
+	bodySetup->CollisionTraceFlag = CTF_UseSimpleAsComplex;
+	bodySetup->bGenerateMirroredCollision = false;
+
+	const FBox bounds = StaticMesh->GetBoundingBox();
+	const FStaticMeshRenderData* renderData = StaticMesh->GetRenderData();
+
+	bool bHasShape = false;
+
+	if (CollisionShape == EBreakableCollisionShape::Convex && renderData && renderData->LODResources.Num() > 0)
+	{
+		// the lowest LOD has the fewest vertices and is close enough to the silhouette for the simulation
+		const FPositionVertexBuffer& positions = renderData->LODResources.Last().VertexBuffers.PositionVertexBuffer;
+		const int32 numVertices = static_cast<int32>(positions.GetNumVertices());
+
+		FKConvexElem convex;
+
+		if (numVertices <= MaxConvexVertices)
+		{
+			for (int32 vertexIndex = 0; vertexIndex < numVertices; ++vertexIndex)
+			{
+				convex.VertexData.AddUnique(FVector(positions.VertexPosition(vertexIndex)));
+			}
+		}
+		else
+		{
+			// the hull is simplified to the vertices furthest along evenly spread directions, each of them is a vertex of the full hull
+			const FVector center = bounds.GetCenter();
+			const float goldenAngle = UE_PI * (3.0f - FMath::Sqrt(5.0f));
+
+			convex.VertexData.Reserve(MaxConvexVertices);
+
+			for (int32 directionIndex = 0; directionIndex < MaxConvexVertices; ++directionIndex)
+			{
+				const float z = 1.0f - 2.0f * (directionIndex + 0.5f) / MaxConvexVertices;
+				const float radius = FMath::Sqrt(1.0f - z * z);
+				const float angle = goldenAngle * directionIndex;
+				const FVector direction(radius * FMath::Cos(angle), radius * FMath::Sin(angle), z);
+
+				int32 supportIndex = 0;
+				double supportDistance = -UE_DOUBLE_BIG_NUMBER;
+
+				for (int32 vertexIndex = 0; vertexIndex < numVertices; ++vertexIndex)
+				{
+					const double distance = FVector::DotProduct(FVector(positions.VertexPosition(vertexIndex)) - center, direction);
+
+					if (distance > supportDistance)
+					{
+						supportIndex = vertexIndex;
+						supportDistance = distance;
+					}
+				}
+
+				convex.VertexData.AddUnique(FVector(positions.VertexPosition(supportIndex)));
+			}
+		}
+
+		if (convex.VertexData.Num() >= 4)
+		{
+			convex.UpdateElemBox();
+
+			bodySetup->AggGeom.ConvexElems.Add(MoveTemp(convex));
+
+			bHasShape = true;
+		}
+		else
+		{
+			UE_LOG(LogGravityBreakableObject, Warning, TEXT("Fracture data '%s' can not build a convex hull for '%s', a box is used instead."), *GetName(), *StaticMesh->GetName());
+		}
+	}
+	else if (CollisionShape == EBreakableCollisionShape::Convex)
+	{
+		UE_LOG(LogGravityBreakableObject, Warning, TEXT("Fracture data '%s' has no render data for '%s', a box is used instead of the convex hull."), *GetName(), *StaticMesh->GetName());
+	}
+
+	if (!bHasShape && CollisionShape == EBreakableCollisionShape::Sphere)
+	{
+		FKSphereElem sphere(bounds.GetExtent().GetMax());
+		sphere.Center = bounds.GetCenter();
+
+		bodySetup->AggGeom.SphereElems.Add(sphere);
+	}
+	else if (!bHasShape)
+	{
+		const FVector boundsSize = bounds.GetSize();
+
+		FKBoxElem box(boundsSize.X, boundsSize.Y, boundsSize.Z);
+		box.Center = bounds.GetCenter();
+
+		bodySetup->AggGeom.BoxElems.Add(box);
+	}
+
+	bodySetup->InvalidatePhysicsData();
+	bodySetup->CreatePhysicsMeshes();
+
+	return bodySetup;
+}
+#endif // WITH_EDITOR
\ No newline at end of file
@@ -2,8 +2,12 @@
 
 #include <Components/SceneComponent.h>
 #include <Components/InstancedStaticMeshComponent.h>
+#include <Engine/StaticMesh.h>
+
+#include "Subsystems/BreakableSubsystem.h"
 
 ABreakableInstancedStaticMeshActor::ABreakableInstancedStaticMeshActor()
+	: NumBrokenInstances(0)
 {
 	BaseISMComponent = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("BreakableInstancedStaticMeshActor_BaseISMComponent"));
 	BrokenISMComponent = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("BreakableInstancedStaticMeshActor_BrokenISMComponent"));
@@ -16,29 +20,22 @@ ABreakableInstancedStaticMeshActor::ABreakableInstancedStaticMeshActor()
 	RootComponent->SetMobility(EComponentMobility::Static);
 }
 
-FActorBreakResult ABreakableInstancedStaticMeshActor::OnBreakActor(UPrimitiveComponent* MyComponent, UPrimitiveComponent* OtherComponent, const FHitResult& Hit)
+FActorBreakResult ABreakableInstancedStaticMeshActor::OnBreakActor(UPrimitiveComponent* MyComponent, UPrimitiveComponent* OtherComponent, const FVector& NormalImpulse, const FHitResult& Hit)
 {
 	FActorBreakResult breakResult;
 
-	if (MyComponent == BaseISMComponent && bIsBreakable)
-	{
-		check(OtherComponent && OtherComponent->Mobility == EComponentMobility::Movable);
-
-		float kineticEnergy = 0.0f;
+	const int32 instanceIndex = Hit.MyItem;
 
-		// @fixme need to figure out how to properly get velocity of the colliding object and the mass of the static component.
-		if (OtherComponent && OtherComponent->IsAnySimulatingPhysics())
+	// the contact impulse works for any other body, also for static or kinematic ones
+	if (MyComponent == BaseISMComponent && !IsInstanceBroken(instanceIndex))
+	{
+		if (InstanceDamage.Num() != BaseISMComponent->GetInstanceCount())
 		{
-			float otherComponentMass = OtherComponent->GetMass();
-			FVector otherComponentVelocity = OtherComponent->GetComponentVelocity();
-
-			kineticEnergy = otherComponentMass * 0.5f * otherComponentVelocity.SquaredLength() * 0.0001f;
+			InstanceDamage.SetNumZeroed(BaseISMComponent->GetInstanceCount());
 		}
 
-		if (kineticEnergy > BreakThreshold)
+		if (ApplyImpulseDamage(InstanceDamage[instanceIndex], NormalImpulse))
 		{
-			int32 instanceIndex = Hit.MyItem;
-			
 			breakResult = BreakInstanceInternal(instanceIndex, false);
 		}
 	}
@@ -57,32 +54,158 @@ FActorBreakResult ABreakableInstancedStaticMeshActor::BreakInstanceInternal(int3
 
 	if (bIsBreakable || bForce)
 	{
-		FTransform instanceTransform;
-
-		// this will replace the base instance with the broken one.
-		// @todo test if the replacing leads to stuttering because of the ISM buffer updates.
-		if (BrokenStaticMesh)
+		// instances are never removed so their indices stay stable, the broken bit is the only state change until the flush
+		if (BrokenInstances.Num() < BaseISMComponent->GetInstanceCount())
 		{
-			BaseISMComponent->GetInstanceTransform(InstanceIndex, instanceTransform);
-
-			BrokenISMComponent->AddInstance(instanceTransform);
+			BrokenInstances.Add(false, BaseISMComponent->GetInstanceCount() - BrokenInstances.Num());
 		}
 
-		BaseISMComponent->RemoveInstance(InstanceIndex);
+		BrokenInstances[InstanceIndex] = true;
+		++NumBrokenInstances;
+
+		FTransform instanceTransform;
+		BaseISMComponent->GetInstanceTransform(InstanceIndex, instanceTransform);
 
-		// this probably will almost never happen but we destory the actor if it has no rendering relevance anymore.
-		if (BaseISMComponent->GetInstanceCount() == 0 && BrokenISMComponent->GetInstanceCount() == 0)
+		PendingBrokenInstances.Add(InstanceIndex);
+
+		// all breaks of a frame update the instance buffers once
+		if (UBreakableSubsystem* breakableSubsystem = GetWorld()->GetSubsystem<UBreakableSubsystem>())
+		{
+			breakableSubsystem->RequestFlush(this);
+		}
+		else
 		{
-			Destroy();
+			OnFlushBreaks();
 		}
 
 		breakResult.bIsBroken = true;
 		breakResult.DebrisTransform = instanceTransform;
+		breakResult.BrokenItem = InstanceIndex;
 	}
 
 	return breakResult;
 }
 
+void ABreakableInstancedStaticMeshActor::OnFlushBreaks()
+{
+	if (PendingBrokenInstances.Num() == 0)
+	{
+		return;
+	}
+
+	TArray<FTransform> brokenInstanceTransforms;
+	brokenInstanceTransforms.Reserve(PendingBrokenInstances.Num());
+
+	for (const int32 instanceIndex : PendingBrokenInstances)
+	{
+		FTransform instanceTransform;
+		BaseISMComponent->GetInstanceTransform(instanceIndex, instanceTransform);
+
+		if (BrokenStaticMesh)
+		{
+			brokenInstanceTransforms.Add(instanceTransform);
+		}
+
+		// a zero scale hides the instance and the ISM component destroys its physics body,
+		// the render state is marked dirty once after all instances are updated.
+		instanceTransform.SetScale3D(FVector::ZeroVector);
+
+		BaseISMComponent->UpdateInstanceTransform(instanceIndex, instanceTransform, false, false, true);
+	}
+
+	BaseISMComponent->MarkRenderStateDirty();
+
+	if (brokenInstanceTransforms.Num() > 0)
+	{
+		BrokenISMComponent->AddInstances(brokenInstanceTransforms, false);
+	}
+
+	PendingBrokenInstances.Reset();
+
+	// this probably will almost never happen but we destory the actor if it has no rendering relevance anymore.
+	if (NumBrokenInstances >= BaseISMComponent->GetInstanceCount() && BrokenISMComponent->GetInstanceCount() == 0)
+	{
+		Destroy();
+	}
+}
+
+bool ABreakableInstancedStaticMeshActor::BreakItem(int32 Item)
+{
+	return BreakInstance(Item, false);
+}
+
+void ABreakableInstancedStaticMeshActor::GetBreakableItems(TArray<FBreakableItem>& OutItems) const
+{
+	const UStaticMesh* staticMesh = BaseISMComponent->GetStaticMesh();
+
+	if (!staticMesh)
+	{
+		return;
+	}
+
+	const FBoxSphereBounds meshBounds = staticMesh->GetBounds();
+	const int32 numInstances = BaseISMComponent->GetInstanceCount();
+
+	OutItems.Reserve(OutItems.Num() + numInstances - NumBrokenInstances);
+
+	for (int32 instanceIndex = 0; instanceIndex < numInstances; ++instanceIndex)
+	{
+		if (IsInstanceBroken(instanceIndex))
+		{
+			continue;
+		}
+
+		FTransform instanceTransform;
+		BaseISMComponent->GetInstanceTransform(instanceIndex, instanceTransform, true);
+
+		const FBoxSphereBounds instanceBounds = meshBounds.TransformBy(instanceTransform);
+
+		FBreakableItem& breakableItem = OutItems.AddDefaulted_GetRef();
+		breakableItem.Component = BaseISMComponent;
+		breakableItem.Item = instanceIndex;
+		breakableItem.Bounds = instanceBounds.GetSphere();
+		breakableItem.Box = instanceBounds.GetBox();
+	}
+}
+
+bool ABreakableInstancedStaticMeshActor::GetBrokenState(TBitArray<>& OutBrokenItems) const
+{
+	if (NumBrokenInstances == 0)
+	{
+		return false;
+	}
+
+	OutBrokenItems = BrokenInstances;
+
+	return true;
+}
+
+void ABreakableInstancedStaticMeshActor::ApplyBrokenState(const TBitArray<>& BrokenItems)
+{
+	const int32 numInstances = BaseISMComponent->GetInstanceCount();
+
+	if (BrokenInstances.Num() < numInstances)
+	{
+		BrokenInstances.Add(false, numInstances - BrokenInstances.Num());
+	}
+
+	// all restored instances go through a single flush instead of one update per instance
+	for (TConstSetBitIterator<> brokenItemIt(BrokenItems); brokenItemIt; ++brokenItemIt)
+	{
+		const int32 instanceIndex = brokenItemIt.GetIndex();
+
+		if (instanceIndex < numInstances && !BrokenInstances[instanceIndex])
+		{
+			BrokenInstances[instanceIndex] = true;
+			++NumBrokenInstances;
+
+			PendingBrokenInstances.Add(instanceIndex);
+		}
+	}
+
+	OnFlushBreaks();
+}
+
 bool ABreakableInstancedStaticMeshActor::BreakInstance(int32 InstanceIndex, bool bForce)
 {
 	FActorBreakResult breakResult = BreakInstanceInternal(InstanceIndex, bForce);
@@ -94,8 +217,12 @@ bool ABreakableInstancedStaticMeshActor::BreakInstance(int32 InstanceIndex, bool
 
 bool ABreakableInstancedStaticMeshActor::IsInstanceBroken(int32 InstanceIndex) const
 {
-	// broken instances are removed from the base ISM component
-	return !BaseISMComponent->IsValidInstance(InstanceIndex);
+	if (!BaseISMComponent->IsValidInstance(InstanceIndex))
+	{
+		return true;
+	}
+
+	return BrokenInstances.IsValidIndex(InstanceIndex) && BrokenInstances[InstanceIndex];
 }
 
 #if WITH_EDITOR
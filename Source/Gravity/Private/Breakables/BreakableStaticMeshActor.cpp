@@ -4,6 +4,7 @@
 
 ABreakableStaticMeshActor::ABreakableStaticMeshActor()
 	: bIsActorBroken(false)
+	, Damage(0.0f)
 {
 	StaticMeshComponent = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("BreakableStaticMeshActor_StaticMeshComponent"));
 
@@ -15,34 +16,14 @@ ABreakableStaticMeshActor::ABreakableStaticMeshActor()
 	StaticMeshComponent->SetNotifyRigidBodyCollision(true);
 }
 
-FActorBreakResult ABreakableStaticMeshActor::OnBreakActor(UPrimitiveComponent* MyComponent, UPrimitiveComponent* OtherComponent, const FHitResult& Hit)
+FActorBreakResult ABreakableStaticMeshActor::OnBreakActor(UPrimitiveComponent* MyComponent, UPrimitiveComponent* OtherComponent, const FVector& NormalImpulse, const FHitResult& Hit)
 {
 	FActorBreakResult breakResult;
 
-	if (!bIsActorBroken && bIsBreakable)
+	// the contact impulse already accounts for the masses and velocities of both bodies
+	if (!bIsActorBroken && ApplyImpulseDamage(Damage, NormalImpulse))
 	{
-		FVector componentVelocity = MyComponent->GetComponentVelocity();
-		float componentMass = MyComponent->GetMass();
-
-		FVector relativeComponentVelocity(0.0);
-
-		if (OtherComponent && OtherComponent->Mobility == EComponentMobility::Movable)
-		{
-			relativeComponentVelocity = OtherComponent->GetComponentVelocity() - componentVelocity;
-		}
-		else
-		{
-			relativeComponentVelocity = componentVelocity;
-		}
-
-		// @fixme this test is too simple and will lead to a lot of invalid break events.
-		// this test works because of the transmission of the energy when the objects collide.
-		float kineticEnergy = componentMass * 0.5f * relativeComponentVelocity.SquaredLength() * 0.0001f;
-
-		if (kineticEnergy >= BreakThreshold)
-		{
-			breakResult = BreakActorInternal(false);
-		}
+		breakResult = BreakActorInternal(false);
 	}
 
 	return breakResult;
@@ -63,23 +44,69 @@ FActorBreakResult ABreakableStaticMeshActor::BreakActorInternal(bool bForce)
 
 		breakResult.bIsBroken = bIsActorBroken;
 		breakResult.DebrisTransform = StaticMeshComponent->GetComponentTransform().GetRelativeTransform(GetActorTransform());
+		breakResult.DebrisLinearVelocity = StaticMeshComponent->GetPhysicsLinearVelocity();
 
-		StaticMeshComponent->SetNotifyRigidBodyCollision(false);
-
-		if (BrokenStaticMesh)
-		{
-			StaticMeshComponent->SetStaticMesh(BrokenStaticMesh);
-		}
-		else
-		{
-			// no broken static mesh was assigned, we do not need this actor anymore because it will not be rendered
-			Destroy();
-		}
+		SetBrokenMesh();
 	}
 
 	return breakResult;
 }
 
+void ABreakableStaticMeshActor::SetBrokenMesh()
+{
+	StaticMeshComponent->SetNotifyRigidBodyCollision(false);
+
+	if (BrokenStaticMesh)
+	{
+		StaticMeshComponent->SetStaticMesh(BrokenStaticMesh);
+	}
+	else
+	{
+		// no broken static mesh was assigned, we do not need this actor anymore because it will not be rendered
+		Destroy();
+	}
+}
+
+bool ABreakableStaticMeshActor::GetBrokenState(TBitArray<>& OutBrokenItems) const
+{
+	if (bIsActorBroken)
+	{
+		OutBrokenItems.Init(true, 1);
+	}
+
+	return bIsActorBroken;
+}
+
+void ABreakableStaticMeshActor::ApplyBrokenState(const TBitArray<>& BrokenItems)
+{
+	if (!bIsActorBroken && BrokenItems.Num() > 0 && BrokenItems[0])
+	{
+		bIsActorBroken = true;
+
+		SetBrokenMesh();
+	}
+}
+
+bool ABreakableStaticMeshActor::BreakItem(int32 Item)
+{
+	return BreakActor(false);
+}
+
+void ABreakableStaticMeshActor::GetBreakableItems(TArray<FBreakableItem>& OutItems) const
+{
+	if (bIsActorBroken)
+	{
+		return;
+	}
+
+	// the actor simulates physics, its bounds are read again on each query
+	FBreakableItem& breakableItem = OutItems.AddDefaulted_GetRef();
+	breakableItem.Component = StaticMeshComponent;
+	breakableItem.Bounds = StaticMeshComponent->Bounds.GetSphere();
+	breakableItem.Box = StaticMeshComponent->Bounds.GetBox();
+	breakableItem.bIsMovable = StaticMeshComponent->Mobility == EComponentMobility::Movable;
+}
+
 bool ABreakableStaticMeshActor::BreakActor(bool bForce)
 {
 	FActorBreakResult breakResult = BreakActorInternal(bForce);
@@ -1,47 +1,236 @@
 #include "Breakables/DebrisStaticMeshActor.h"
 
 #include <Components/SceneComponent.h>
+#include <Engine/StaticMesh.h>
 
+#include "Breakables/BreakableFractureData.h"
 #include "Breakables/DebrisStaticMeshComponent.h"
+#include "Subsystems/DebrisSubsystem.h"
 
 ADebrisStaticMeshActor::ADebrisStaticMeshActor()
+	: NumAliveDebris(0)
 {
-	PrimaryActorTick.bCanEverTick = true;
+	// the debris objects are updated by the debris subsystem
+	PrimaryActorTick.bCanEverTick = false;
 
 	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("DebrisStaticMeshActor_RootComponent"));
 
 	RootComponent->SetMobility(EComponentMobility::Movable);
 }
 
-void ADebrisStaticMeshActor::TickActor(float DeltaTime, ELevelTick TickType, FActorTickFunction& ThisTickFunction)
+UDebrisStaticMeshComponent* ADebrisStaticMeshActor::AddDebris()
+{
+	UDebrisStaticMeshComponent* debrisComponent = NewObject<UDebrisStaticMeshComponent>(this);
+
+	// note that the physics system will detach the debris component from the root because physics objects cannot be attached (makes no sense).
+	debrisComponent->AttachToComponent(RootComponent, FAttachmentTransformRules::KeepRelativeTransform);
+
+	// components added after the actor was spawned are not registered by the spawn routine
+	if (HasActorRegisteredAllComponents())
+	{
+		debrisComponent->RegisterComponent();
+	}
+
+	DebrisStaticMeshComponents.Add(debrisComponent);
+
+	return debrisComponent;
+}
+
+void ADebrisStaticMeshActor::PrewarmDebris(const UBreakableFractureData& FractureData)
 {
-	Super::TickActor(DeltaTime, TickType, ThisTickFunction);
+	const TArray<FBreakableFracturePiece>& pieces = FractureData.GetPieces();
+	const TArray<TObjectPtr<UStaticMesh>>& staticMeshes = FractureData.GetLoadedStaticMeshes();
+
+	const int32 numPooledComponents = DebrisStaticMeshComponents.Num();
+
+	TBitArray<> usedComponents(false, numPooledComponents);
+	TArray<int32, TInlineAllocator<32>> unmatchedPieces;
+
+	// the components which already have the mesh of a piece keep their physics body
+	for (int32 pieceIndex = 0; pieceIndex < staticMeshes.Num() && pieceIndex < pieces.Num(); ++pieceIndex)
+	{
+		if (!staticMeshes[pieceIndex])
+		{
+			continue;
+		}
+
+		int32 componentIndex = 0;
+
+		for (; componentIndex < numPooledComponents; ++componentIndex)
+		{
+			if (!usedComponents[componentIndex] && DebrisStaticMeshComponents[componentIndex]->GetStaticMesh() == staticMeshes[pieceIndex])
+			{
+				break;
+			}
+		}
+
+		if (componentIndex < numPooledComponents)
+		{
+			usedComponents[componentIndex] = true;
 
-	bool bHasAlifeDebrisComponents = false;
+			DebrisStaticMeshComponents[componentIndex]->PrewarmDebris(staticMeshes[pieceIndex], pieces[pieceIndex].BodySetup);
+		}
+		else
+		{
+			unmatchedPieces.Add(pieceIndex);
+		}
+	}
+
+	// then change the mesh of the remaining components and create new ones if the actor has not enough of them
+	int32 freeComponentIndex = usedComponents.Find(false);
 
-	for (const UDebrisStaticMeshComponent* debrisComponent : DebrisStaticMeshComponents)
+	for (const int32 pieceIndex : unmatchedPieces)
 	{
-		if (debrisComponent->IsDebrisAlife())
+		UDebrisStaticMeshComponent* debrisComponent = nullptr;
+
+		if (freeComponentIndex != INDEX_NONE)
 		{
-			bHasAlifeDebrisComponents = true;
-			break;
+			debrisComponent = DebrisStaticMeshComponents[freeComponentIndex];
+
+			usedComponents[freeComponentIndex] = true;
+			freeComponentIndex = usedComponents.FindFrom(false, freeComponentIndex);
+		}
+		else
+		{
+			debrisComponent = AddDebris();
 		}
+
+		debrisComponent->PrewarmDebris(staticMeshes[pieceIndex], pieces[pieceIndex].BodySetup);
 	}
+}
+
+bool ADebrisStaticMeshActor::HasDebrisMeshes(const UBreakableFractureData& FractureData) const
+{
+	TArray<const UStaticMesh*, TInlineAllocator<32>> staticMeshes;
 
-	if (!bHasAlifeDebrisComponents)
+	for (const TObjectPtr<UStaticMesh>& staticMesh : FractureData.GetLoadedStaticMeshes())
 	{
-		Destroy();
+		staticMeshes.Add(staticMesh);
 	}
+
+	return HasDebrisMeshes(staticMeshes);
 }
 
-UDebrisStaticMeshComponent* ADebrisStaticMeshActor::AddDebris()
+bool ADebrisStaticMeshActor::HasDebrisMeshes(const FDebrisSpawnParameters& SpawnParameters) const
 {
-	UDebrisStaticMeshComponent* debrisComponent = NewObject<UDebrisStaticMeshComponent>(this);
+	TArray<const UStaticMesh*, TInlineAllocator<32>> staticMeshes;
 
-	// note that the physics system will detach the debris component from the root because physics objects cannot be attached (makes no sense).
-	debrisComponent->AttachToComponent(RootComponent, FAttachmentTransformRules::KeepRelativeTransform);
+	for (const FDebrisPieceParameters& piece : SpawnParameters.Pieces)
+	{
+		staticMeshes.Add(piece.StaticMesh);
+	}
 
-	DebrisStaticMeshComponents.Add(debrisComponent);
+	return HasDebrisMeshes(staticMeshes);
+}
 
-	return debrisComponent;
+bool ADebrisStaticMeshActor::HasDebrisMeshes(TConstArrayView<const UStaticMesh*> StaticMeshes) const
+{
+	const int32 numPooledComponents = DebrisStaticMeshComponents.Num();
+
+	TBitArray<> usedComponents(false, numPooledComponents);
+	bool bHasMesh = false;
+
+	for (const UStaticMesh* staticMesh : StaticMeshes)
+	{
+		if (!staticMesh)
+		{
+			continue;
+		}
+
+		int32 componentIndex = 0;
+
+		for (; componentIndex < numPooledComponents; ++componentIndex)
+		{
+			if (!usedComponents[componentIndex] && DebrisStaticMeshComponents[componentIndex]->GetStaticMesh() == staticMesh)
+			{
+				break;
+			}
+		}
+
+		if (componentIndex == numPooledComponents)
+		{
+			return false;
+		}
+
+		usedComponents[componentIndex] = true;
+		bHasMesh = true;
+	}
+
+	return bHasMesh;
+}
+
+void ADebrisStaticMeshActor::ActivateDebris(const FDebrisSpawnParameters& SpawnParameters, TArray<UDebrisStaticMeshComponent*>& OutActivatedDebris)
+{
+	SetActorTransform(SpawnParameters.Transform, false, nullptr, ETeleportType::ResetPhysics);
+
+	const int32 numPooledComponents = DebrisStaticMeshComponents.Num();
+	const int32 firstActivatedDebris = OutActivatedDebris.Num();
+
+	TBitArray<> usedComponents(false, numPooledComponents);
+	TArray<const FDebrisPieceParameters*, TInlineAllocator<16>> unmatchedPieces;
+
+	// first reuse the components which already have the requested mesh because changing the mesh recreates the physics body
+	for (const FDebrisPieceParameters& piece : SpawnParameters.Pieces)
+	{
+		if (!piece.StaticMesh)
+		{
+			continue;
+		}
+
+		int32 componentIndex = 0;
+
+		for (; componentIndex < numPooledComponents; ++componentIndex)
+		{
+			if (!usedComponents[componentIndex] && DebrisStaticMeshComponents[componentIndex]->GetStaticMesh() == piece.StaticMesh)
+			{
+				break;
+			}
+		}
+
+		if (componentIndex < numPooledComponents)
+		{
+			usedComponents[componentIndex] = true;
+
+			DebrisStaticMeshComponents[componentIndex]->ActivateDebris(piece, SpawnParameters);
+
+			OutActivatedDebris.Add(DebrisStaticMeshComponents[componentIndex]);
+		}
+		else
+		{
+			unmatchedPieces.Add(&piece);
+		}
+	}
+
+	// then fill the remaining components and create new ones if the pooled actor has not enough of them
+	int32 freeComponentIndex = usedComponents.Find(false);
+
+	for (const FDebrisPieceParameters* piece : unmatchedPieces)
+	{
+		UDebrisStaticMeshComponent* debrisComponent = nullptr;
+
+		if (freeComponentIndex != INDEX_NONE)
+		{
+			debrisComponent = DebrisStaticMeshComponents[freeComponentIndex];
+
+			usedComponents[freeComponentIndex] = true;
+			freeComponentIndex = usedComponents.FindFrom(false, freeComponentIndex);
+		}
+		else
+		{
+			debrisComponent = AddDebris();
+		}
+
+		debrisComponent->ActivateDebris(*piece, SpawnParameters);
+
+		OutActivatedDebris.Add(debrisComponent);
+	}
+
+	NumAliveDebris = OutActivatedDebris.Num() - firstActivatedDebris;
+}
+
+bool ADebrisStaticMeshActor::NotifyDebrisDespawned()
+{
+	check(NumAliveDebris > 0);
+
+	return --NumAliveDebris == 0;
 }
\ No newline at end of file
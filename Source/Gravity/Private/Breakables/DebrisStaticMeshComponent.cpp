@@ -1,111 +1,135 @@
 #include "Breakables/DebrisStaticMeshComponent.h"
 
+#include <GameFramework/WorldSettings.h>
 #include <PhysicsEngine/BodyInstance.h>
 
+#include "Subsystems/DebrisSubsystem.h"
+#include "Subsystems/GravityFieldSubsystem.h"
+
 UDebrisStaticMeshComponent::UDebrisStaticMeshComponent()
-	: DebrisLifetime(5.0f)
-	, DebrisDespawnDuration(2.0f)
-	, bIsDispawning(false)
-	, bIsDebrisAlife(true)
+	: DebrisRecordIndex(INDEX_NONE)
+	, bIsFading(false)
+	, bIsCosmetic(false)
 {
-	DebrisStartDespawnTimeout = DebrisLifetime;
-	DebrisDespawnTimeout = DebrisDespawnDuration;
+	PrimaryComponentTick.bCanEverTick = false;
 
-	PrimaryComponentTick.bCanEverTick = true;
+	// the debris subsystem schedules the despawn when the body falls asleep
+	BodyInstance.bGenerateWakeEvents = true;
 
-	SetSimulatePhysics(true);
+	// keep the physics body while the debris is pooled without collision, creating bodies on break leads to stuttering
+	bAlwaysCreatePhysicsState = true;
+
+	// debris is created inactive and waits in the pool until it is activated
+	SetVisibility(false, false);
+	SetCollisionEnabled(ECollisionEnabled::NoCollision);
 }
 
-void UDebrisStaticMeshComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+UBodySetup* UDebrisStaticMeshComponent::GetBodySetup()
 {
-	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	return DebrisBodySetup ? DebrisBodySetup.Get() : Super::GetBodySetup();
+}
+
+void UDebrisStaticMeshComponent::ActivateDebris(const FDebrisPieceParameters& Piece, const FDebrisSpawnParameters& SpawnParameters)
+{
+	PrewarmDebris(Piece.StaticMesh, Piece.BodySetup);
+
+	if (BodyInstance.PhysMaterialOverride != SpawnParameters.PhysicalMaterial)
+	{
+		SetPhysMaterialOverride(SpawnParameters.PhysicalMaterial);
+	}
+
+	const bool bOverrideMass = Piece.Mass > 0.0f;
+
+	if (BodyInstance.bOverrideMass != bOverrideMass || (bOverrideMass && BodyInstance.GetMassOverride() != Piece.Mass))
+	{
+		SetMassOverrideInKg(NAME_None, Piece.Mass, bOverrideMass);
+	}
 
-	if (!bIsDispawning)
+	// the responses are only touched when the debris switches between full and cosmetic
+	if (bIsCosmetic != SpawnParameters.bIsCosmetic)
 	{
-		if (!IsAnyRigidBodyAwake())
+		bIsCosmetic = SpawnParameters.bIsCosmetic;
+
+		if (bIsCosmetic)
 		{
-			DebrisStartDespawnTimeout -= DeltaTime;
+			FullCollisionResponses = GetCollisionResponseToChannels();
 
-			if (DebrisStartDespawnTimeout <= 0)
-			{
-				OnBeginDespawn();
-			}
+			SetCollisionResponseToAllChannels(ECR_Ignore);
+			SetCollisionResponseToChannel(ECC_WorldStatic, ECR_Block);
 		}
 		else
 		{
-			// we have to reset the timeout because the rigid body was moved
-			DebrisStartDespawnTimeout = DebrisLifetime;
+			SetCollisionResponseToChannels(FullCollisionResponses);
+		}
+	}
 
-			AActor* debrisActor = GetOwner();
-			checkf(debrisActor, TEXT("UDebrisStaticMeshComponent must be owned by ADebrisStaticMeshActor."));
+	SetWorldTransform(Piece.RelativeTransform * SpawnParameters.Transform, false, nullptr, ETeleportType::ResetPhysics);
+	SetCollisionEnabled(bIsCosmetic ? ECollisionEnabled::PhysicsOnly : ECollisionEnabled::QueryAndPhysics);
+	SetSimulatePhysics(true);
+	SetPhysicsLinearVelocity(SpawnParameters.LinearVelocity);
 
-			if (!CheckStillInWorld())
-			{
-				// we are not in the world anymore, despawn the debris immediately
-				DespawnImmediately();
-			}
-		}
+	if (UGravityFieldSubsystem* gravityFieldSubsystem = GetWorld()->GetSubsystem<UGravityFieldSubsystem>())
+	{
+		gravityFieldSubsystem->RegisterBody(this);
 	}
-	else
+
+	// a start time in the far future keeps the material opaque
+	if (bIsFading)
 	{
-		DebrisDespawnTimeout -= DeltaTime;
+		SetCustomPrimitiveDataFloat(0, TNumericLimits<float>::Max());
 
-		if (DebrisDespawnTimeout <= 0)
-		{
-			OnEndDespawn();
-		}
+		bIsFading = false;
 	}
-}
 
-void UDebrisStaticMeshComponent::OnBeginDespawn()
-{
-	bIsDispawning = true;
-
-	SetSimulatePhysics(false);
-	SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	SetVisibility(true, false);
 }
 
-void UDebrisStaticMeshComponent::OnEndDespawn()
+void UDebrisStaticMeshComponent::PrewarmDebris(UStaticMesh* StaticMesh, UBodySetup* BodySetup)
 {
-	SetVisibility(false, false);
-	SetComponentTickEnabled(false);
+	const bool bBodySetupChanged = DebrisBodySetup != BodySetup;
 
-	bIsDebrisAlife = false;
-	bIsDispawning = false;
-}
+	DebrisBodySetup = BodySetup;
 
-void UDebrisStaticMeshComponent::DespawnImmediately()
-{
-	if (bIsDebrisAlife)
+	// changing the mesh recreates the body with the new body setup
+	if (GetStaticMesh() != StaticMesh)
 	{
-		OnBeginDespawn();
-		OnEndDespawn();
+		SetStaticMesh(StaticMesh);
+	}
+	else if (bBodySetupChanged)
+	{
+		RecreatePhysicsState();
 	}
 }
 
-bool UDebrisStaticMeshComponent::CheckStillInWorld()
+void UDebrisStaticMeshComponent::BeginDespawn()
 {
-	const UWorld* myWorld = GetWorld();
-	if (!myWorld)
+	if (UGravityFieldSubsystem* gravityFieldSubsystem = GetWorld()->GetSubsystem<UGravityFieldSubsystem>())
 	{
-		return false;
+		gravityFieldSubsystem->UnregisterBody(this);
 	}
 
-	AWorldSettings* worldSettings = myWorld->GetWorldSettings(true);
-	if (!worldSettings->AreWorldBoundsChecksEnabled())
-	{
-		return true;
-	}
+	SetSimulatePhysics(false);
+	SetCollisionEnabled(ECollisionEnabled::NoCollision);
+}
 
-	AActor* actorOwner = GetOwner();
-	if (!IsValid(actorOwner))
-	{
-		return false;
-	}
+void UDebrisStaticMeshComponent::SetDespawnFade(float StartTime, float Duration)
+{
+	SetCustomPrimitiveDataFloat(0, StartTime);
+	SetCustomPrimitiveDataFloat(1, Duration);
+
+	bIsFading = true;
+}
+
+void UDebrisStaticMeshComponent::EndDespawn()
+{
+	SetVisibility(false, false);
+}
 
+bool UDebrisStaticMeshComponent::IsInsideWorldBounds(const AWorldSettings& WorldSettings) const
+{
 	FVector componentLocation = GetComponentLocation();
 
-	if (componentLocation.Z < worldSettings->KillZ)
+	if (componentLocation.Z < WorldSettings.KillZ)
 	{
 		return false;
 	}
@@ -0,0 +1,459 @@
+#include "Stasis/StasisControllerComponent.h"
+
+#include <Engine/World.h>
+#include <Engine/OverlapResult.h>
+#include <Components/PrimitiveComponent.h>
+#include <Chaos/SimCallbackObject.h>
+#include <Chaos/SimCallbackInput.h>
+#include <Chaos/KinematicTargets.h>
+#include <PBDRigidsSolver.h>
+#include <Physics/Experimental/PhysScene_Chaos.h>
+#include <PhysicsProxy/SingleParticlePhysicsProxy.h>
+
+#include "Breakables/DebrisStaticMeshComponent.h"
+#include "Subsystems/DebrisSubsystem.h"
+#include "Subsystems/GravityFieldSubsystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("Stasis Orbit Pass"), STAT_StasisOrbitPass, STATGROUP_GravityField);
+
+/**
+ * Orbit and slots sent from the game thread.
+ */
+struct FStasisSimInput : public Chaos::FSimCallbackInput
+{
+	/** Physics proxies of the grabbed bodies, one per slot. */
+	TArray<FPhysicsActorHandle> Proxies;
+
+	/** Offsets of the orbit slots, one per slot. */
+	TArray<FVector> SlotOffsets;
+
+	/** World location of the orbit center. */
+	FVector OrbitCenter = FVector::ZeroVector;
+
+	/** Angular speed of the orbit in rad/s. */
+	float OrbitSpeed = 0.0f;
+
+	/** Maximum speed in cm/s at which the bodies move toward their slot. */
+	float PullSpeed = 0.0f;
+
+	/** True if the input holds the slots, the slots of a frame without grabs or releases are not sent. */
+	bool bHasSlots = false;
+
+	void Reset()
+	{
+		Proxies.Reset();
+		SlotOffsets.Reset();
+		bHasSlots = false;
+	}
+};
+
+/**
+ * Moves the grabbed bodies toward their orbit slots with kinematic targets before each physics step.
+ */
+class FStasisSimCallback : public Chaos::TSimCallbackObject<FStasisSimInput>
+{
+private:
+	virtual void OnPreSimulate_Internal() override
+	{
+		SCOPE_CYCLE_COUNTER(STAT_StasisOrbitPass);
+
+		if (const FStasisSimInput* input = GetConsumerInput_Internal())
+		{
+			OrbitCenter = input->OrbitCenter;
+			OrbitSpeed = input->OrbitSpeed;
+			PullSpeed = input->PullSpeed;
+
+			if (input->bHasSlots)
+			{
+				Proxies = input->Proxies;
+				SlotOffsets = input->SlotOffsets;
+			}
+		}
+
+		if (Proxies.Num() == 0)
+		{
+			return;
+		}
+
+		const float deltaTime = GetDeltaTime_Internal();
+
+		// the orbit advances with the physics steps, so it stays smooth if the game thread runs at a different rate
+		OrbitAngle = FMath::Fmod(OrbitAngle + OrbitSpeed * deltaTime, UE_TWO_PI);
+
+		const FQuat orbitRotation(FVector::UpVector, OrbitAngle);
+		const double maxStep = PullSpeed * deltaTime;
+
+		for (int32 slotIndex = 0; slotIndex < Proxies.Num(); ++slotIndex)
+		{
+			const FPhysicsActorHandle proxy = Proxies[slotIndex];
+
+			if (!proxy || proxy->GetMarkedDeleted())
+			{
+				continue;
+			}
+
+			Chaos::FRigidBodyHandle_Internal* rigidBody = proxy->GetPhysicsThreadAPI();
+
+			if (!rigidBody || rigidBody->ObjectState() != Chaos::EObjectStateType::Kinematic)
+			{
+				continue;
+			}
+
+			const FVector slotLocation = OrbitCenter + orbitRotation.RotateVector(SlotOffsets[slotIndex]);
+			const FVector location = rigidBody->X();
+			const FVector targetLocation = location + (slotLocation - location).GetClampedToMaxSize(maxStep);
+
+			rigidBody->SetKinematicTarget(Chaos::FKinematicTarget::MakePositionTarget(FTransform(rigidBody->R(), targetLocation)));
+		}
+	}
+
+private:
+	// Physics proxies of the grabbed bodies, one per slot.
+	TArray<FPhysicsActorHandle> Proxies;
+
+	// Offsets of the orbit slots, one per slot.
+	TArray<FVector> SlotOffsets;
+
+	// World location of the orbit center.
+	FVector OrbitCenter = FVector::ZeroVector;
+
+	// Angular speed of the orbit in rad/s.
+	float OrbitSpeed = 0.0f;
+
+	// Maximum speed at which the bodies move toward their slot.
+	float PullSpeed = 0.0f;
+
+	// Current rotation of the orbit around the up axis in rad.
+	float OrbitAngle = 0.0f;
+};
+
+UStasisControllerComponent::UStasisControllerComponent()
+	: MaxGrabbed(64)
+	, GrabRadius(1000.0f)
+	, bGrabSpawnedDebris(false)
+	, OrbitRadius(300.0f)
+	, NumOrbitRings(3)
+	, OrbitRingSpacing(80.0f)
+	, OrbitSpeed(45.0f)
+	, PullSpeed(1500.0f)
+	, SimCallback(nullptr)
+	, bSlotsDirty(false)
+{
+	// the orbit center is sent to the physics thread before the physics step of the frame
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.TickGroup = TG_PrePhysics;
+}
+
+void UStasisControllerComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	FPhysScene* physicsScene = GetWorld()->GetPhysicsScene();
+
+	if (physicsScene && physicsScene->GetSolver())
+	{
+		SimCallback = physicsScene->GetSolver()->CreateAndRegisterSimCallbackObject_External<FStasisSimCallback>();
+	}
+
+	if (UDebrisSubsystem* debrisSubsystem = GetWorld()->GetSubsystem<UDebrisSubsystem>())
+	{
+		debrisSubsystem->OnDebrisSpawned.AddUObject(this, &UStasisControllerComponent::OnDebrisSpawned);
+	}
+}
+
+void UStasisControllerComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	ReleaseAll(FVector::ZeroVector, 0.0f);
+
+	if (UDebrisSubsystem* debrisSubsystem = GetWorld()->GetSubsystem<UDebrisSubsystem>())
+	{
+		debrisSubsystem->OnDebrisSpawned.RemoveAll(this);
+	}
+
+	if (SimCallback)
+	{
+		FPhysScene* physicsScene = GetWorld()->GetPhysicsScene();
+
+		if (physicsScene && physicsScene->GetSolver())
+		{
+			physicsScene->GetSolver()->UnregisterAndFreeSimCallbackObject_External(SimCallback);
+		}
+
+		SimCallback = nullptr;
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UStasisControllerComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	// components destroyed without a physics state change notification, e.g. by garbage collection
+	for (int32 slotIndex = GrabbedComponents.Num() - 1; slotIndex >= 0; --slotIndex)
+	{
+		if (!GrabbedComponents[slotIndex].IsValid())
+		{
+			RemoveSlot(slotIndex);
+		}
+	}
+
+	if (!SimCallback)
+	{
+		return;
+	}
+
+	FStasisSimInput* input = SimCallback->GetProducerInputData_External();
+	input->OrbitCenter = GetComponentLocation();
+	input->OrbitSpeed = FMath::DegreesToRadians(OrbitSpeed);
+	input->PullSpeed = PullSpeed;
+
+	if (bSlotsDirty)
+	{
+		input->Proxies = GrabbedProxies;
+		input->SlotOffsets = SlotOffsets;
+		input->bHasSlots = true;
+
+		bSlotsDirty = false;
+	}
+}
+
+bool UStasisControllerComponent::Grab(UPrimitiveComponent* Component)
+{
+	if (!Component || GrabbedComponents.Num() >= MaxGrabbed || Component->Mobility != EComponentMobility::Movable || GrabbedComponents.Contains(Component))
+	{
+		return false;
+	}
+
+	FBodyInstance* bodyInstance = Component->GetBodyInstance();
+	const FPhysicsActorHandle proxy = bodyInstance ? bodyInstance->GetPhysicsActorHandle() : nullptr;
+
+	if (!proxy)
+	{
+		return false;
+	}
+
+	// debris is kinematic while it is frozen by the debris budget, the debris subsystem decides if it can be held
+	if (UDebrisStaticMeshComponent* debrisComponent = Cast<UDebrisStaticMeshComponent>(Component))
+	{
+		UDebrisSubsystem* debrisSubsystem = GetWorld()->GetSubsystem<UDebrisSubsystem>();
+
+		if (!debrisSubsystem || !debrisSubsystem->HoldDebris(debrisComponent))
+		{
+			return false;
+		}
+	}
+	else if (!Component->IsSimulatingPhysics())
+	{
+		return false;
+	}
+
+	const int32 slotIndex = GrabbedComponents.Add(Component);
+	GrabbedProxies.Add(proxy);
+	SlotOffsets.Add(GetSlotOffset(slotIndex));
+	UpdatedKinematicFromSimulation.Add(bodyInstance->bUpdateKinematicFromSimulation);
+
+	// the kinematic targets are set on the physics thread, the component has to follow the simulated transform
+	bodyInstance->bUpdateKinematicFromSimulation = true;
+
+	Component->SetSimulatePhysics(false);
+	Component->OnComponentPhysicsStateChanged.AddUniqueDynamic(this, &UStasisControllerComponent::OnGrabbedPhysicsStateChanged);
+
+	bSlotsDirty = true;
+
+	return true;
+}
+
+int32 UStasisControllerComponent::GrabComponents(const TArray<UPrimitiveComponent*>& Components)
+{
+	int32 numGrabbed = 0;
+
+	for (UPrimitiveComponent* component : Components)
+	{
+		if (GrabbedComponents.Num() >= MaxGrabbed)
+		{
+			break;
+		}
+
+		if (Grab(component))
+		{
+			++numGrabbed;
+		}
+	}
+
+	return numGrabbed;
+}
+
+int32 UStasisControllerComponent::GrabInRadius()
+{
+	const FVector center = GetComponentLocation();
+
+	TArray<FOverlapResult> overlaps;
+
+	FCollisionQueryParams queryParams(SCENE_QUERY_STAT(StasisGrab), false, GetOwner());
+
+	GetWorld()->OverlapMultiByObjectType(overlaps, center, FQuat::Identity, FCollisionObjectQueryParams(FCollisionObjectQueryParams::AllDynamicObjects),
+		FCollisionShape::MakeSphere(GrabRadius), queryParams);
+
+	TArray<UPrimitiveComponent*> components;
+	components.Reserve(overlaps.Num());
+
+	for (const FOverlapResult& overlap : overlaps)
+	{
+		if (UPrimitiveComponent* component = overlap.GetComponent())
+		{
+			components.AddUnique(component);
+		}
+	}
+
+	// a controller without enough free slots holds the closest objects
+	components.Sort([&center](const UPrimitiveComponent& A, const UPrimitiveComponent& B)
+	{
+		return FVector::DistSquared(center, A.GetComponentLocation()) < FVector::DistSquared(center, B.GetComponentLocation());
+	});
+
+	return GrabComponents(components);
+}
+
+void UStasisControllerComponent::Release(UPrimitiveComponent* Component, const FVector& Impulse)
+{
+	const int32 slotIndex = GrabbedComponents.IndexOfByKey(Component);
+
+	if (slotIndex != INDEX_NONE)
+	{
+		ReleaseSlot(slotIndex, Impulse);
+	}
+}
+
+void UStasisControllerComponent::ReleaseAll(const FVector& LinearImpulse, float RadialImpulse)
+{
+	if (GrabbedComponents.Num() == 0)
+	{
+		return;
+	}
+
+	const FVector center = GetComponentLocation();
+	const float orbitSpeed = FMath::DegreesToRadians(OrbitSpeed);
+
+	// released back to front, so removing a slot never moves a slot which is not released yet
+	for (int32 slotIndex = GrabbedComponents.Num() - 1; slotIndex >= 0; --slotIndex)
+	{
+		const UPrimitiveComponent* component = GrabbedComponents[slotIndex].Get();
+
+		if (!component)
+		{
+			RemoveSlot(slotIndex);
+			continue;
+		}
+
+		const FVector radius = (component->GetComponentLocation() - center) * FVector(1.0, 1.0, 0.0);
+		const FVector orbitVelocity = FVector::CrossProduct(FVector(0.0, 0.0, orbitSpeed), radius);
+
+		ReleaseSlot(slotIndex, LinearImpulse + orbitVelocity + radius.GetSafeNormal() * RadialImpulse);
+	}
+}
+
+FVector UStasisControllerComponent::GetSlotOffset(int32 SlotIndex) const
+{
+	// the golden angle keeps consecutive slots apart for any number of grabbed objects
+	const float angle = SlotIndex * 2.39996323f;
+	const int32 ring = SlotIndex % FMath::Max(NumOrbitRings, 1);
+	const float height = (ring - (FMath::Max(NumOrbitRings, 1) - 1) * 0.5f) * OrbitRingSpacing;
+
+	return FVector(FMath::Cos(angle) * OrbitRadius, FMath::Sin(angle) * OrbitRadius, height);
+}
+
+void UStasisControllerComponent::ReleaseSlot(int32 SlotIndex, const FVector& Impulse)
+{
+	UPrimitiveComponent* component = GrabbedComponents[SlotIndex].Get();
+	const bool bUpdateKinematicFromSimulation = UpdatedKinematicFromSimulation[SlotIndex];
+
+	RemoveSlot(SlotIndex);
+
+	if (!component)
+	{
+		return;
+	}
+
+	if (FBodyInstance* bodyInstance = component->GetBodyInstance())
+	{
+		bodyInstance->bUpdateKinematicFromSimulation = bUpdateKinematicFromSimulation;
+	}
+
+	component->SetSimulatePhysics(true);
+	component->AddImpulse(Impulse, NAME_None, true);
+
+	if (UDebrisStaticMeshComponent* debrisComponent = Cast<UDebrisStaticMeshComponent>(component))
+	{
+		if (UDebrisSubsystem* debrisSubsystem = GetWorld()->GetSubsystem<UDebrisSubsystem>())
+		{
+			debrisSubsystem->ReleaseHeldDebris(debrisComponent);
+		}
+	}
+}
+
+void UStasisControllerComponent::RemoveSlot(int32 SlotIndex)
+{
+	if (UPrimitiveComponent* component = GrabbedComponents[SlotIndex].Get())
+	{
+		component->OnComponentPhysicsStateChanged.RemoveDynamic(this, &UStasisControllerComponent::OnGrabbedPhysicsStateChanged);
+	}
+
+	GrabbedComponents.RemoveAtSwap(SlotIndex);
+	GrabbedProxies.RemoveAtSwap(SlotIndex);
+	SlotOffsets.RemoveAtSwap(SlotIndex);
+
+	// TBitArray has no swap removal
+	const int32 lastSlotIndex = UpdatedKinematicFromSimulation.Num() - 1;
+	UpdatedKinematicFromSimulation[SlotIndex] = UpdatedKinematicFromSimulation[lastSlotIndex];
+	UpdatedKinematicFromSimulation.RemoveAt(lastSlotIndex);
+
+	// the last object takes over the freed slot and flies over to it
+	if (SlotIndex < SlotOffsets.Num())
+	{
+		SlotOffsets[SlotIndex] = GetSlotOffset(SlotIndex);
+	}
+
+	bSlotsDirty = true;
+}
+
+void UStasisControllerComponent::OnDebrisSpawned(TConstArrayView<UDebrisStaticMeshComponent*> SpawnedDebris)
+{
+	if (!bGrabSpawnedDebris)
+	{
+		return;
+	}
+
+	const FVector center = GetComponentLocation();
+	const double grabRadiusSquared = FMath::Square(GrabRadius);
+
+	for (UDebrisStaticMeshComponent* debrisComponent : SpawnedDebris)
+	{
+		if (GrabbedComponents.Num() >= MaxGrabbed)
+		{
+			break;
+		}
+
+		// cosmetic debris does not take part in gameplay
+		if (debrisComponent->GetCollisionEnabled() == ECollisionEnabled::QueryAndPhysics &&
+			FVector::DistSquared(center, debrisComponent->GetComponentLocation()) <= grabRadiusSquared)
+		{
+			Grab(debrisComponent);
+		}
+	}
+}
+
+void UStasisControllerComponent::OnGrabbedPhysicsStateChanged(UPrimitiveComponent* ChangedComponent, EComponentPhysicsStateChange StateChange)
+{
+	if (StateChange != EComponentPhysicsStateChange::Destroyed)
+	{
+		return;
+	}
+
+	const int32 slotIndex = GrabbedComponents.IndexOfByKey(ChangedComponent);
+
+	if (slotIndex != INDEX_NONE)
+	{
+		RemoveSlot(slotIndex);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,163 @@
+#include "Subsystems/BreakableGrid.h"
+
+FBreakableGrid::FBreakableGrid(float InCellSize)
+	: CellSize(InCellSize)
+	, MaxRadius(0.0f)
+	, NumMaxRadiusElements(0)
+	, NumElements(0)
+{
+	check(CellSize > 0.0f);
+}
+
+void FBreakableGrid::Add(int32 Id, const FVector& Center, float Radius)
+{
+	check(Id >= 0);
+
+	if (Elements.Num() <= Id)
+	{
+		Elements.SetNum(Id + 1);
+	}
+
+	FElement& element = Elements[Id];
+
+	checkf(!element.bIsValid, TEXT("Element %d is already in the breakable grid."), Id);
+
+	element.Center = Center;
+	element.Radius = Radius;
+	element.Cell = GetCell(Center);
+	element.bIsValid = true;
+
+	Cells.FindOrAdd(element.Cell).Add(Id);
+
+	if (Radius > MaxRadius)
+	{
+		MaxRadius = Radius;
+		NumMaxRadiusElements = 1;
+	}
+	else if (Radius == MaxRadius)
+	{
+		++NumMaxRadiusElements;
+	}
+
+	++NumElements;
+}
+
+void FBreakableGrid::Remove(int32 Id)
+{
+	if (!Elements.IsValidIndex(Id) || !Elements[Id].bIsValid)
+	{
+		return;
+	}
+
+	FElement& element = Elements[Id];
+
+	if (TArray<int32>* cell = Cells.Find(element.Cell))
+	{
+		cell->RemoveSingleSwap(Id);
+
+		if (cell->Num() == 0)
+		{
+			Cells.Remove(element.Cell);
+		}
+	}
+
+	element.bIsValid = false;
+
+	--NumElements;
+
+	// the queries shrink again once the largest elements are gone
+	if (element.Radius == MaxRadius && --NumMaxRadiusElements == 0)
+	{
+		MaxRadius = 0.0f;
+
+		for (const FElement& otherElement : Elements)
+		{
+			if (!otherElement.bIsValid)
+			{
+				continue;
+			}
+
+			if (otherElement.Radius > MaxRadius)
+			{
+				MaxRadius = otherElement.Radius;
+				NumMaxRadiusElements = 1;
+			}
+			else if (otherElement.Radius == MaxRadius)
+			{
+				++NumMaxRadiusElements;
+			}
+		}
+	}
+}
+
+void FBreakableGrid::Query(const FBox& Box, TArray<int32>& OutIds) const
+{
+	if (NumElements == 0)
+	{
+		return;
+	}
+
+	// elements are stored by their center only, the query has to cover the centers of all elements reaching into the box
+	const FIntVector minCell = GetCell(Box.Min - FVector(MaxRadius));
+	const FIntVector maxCell = GetCell(Box.Max + FVector(MaxRadius));
+
+	const int64 numQueryCells = static_cast<int64>(maxCell.X - minCell.X + 1) * (maxCell.Y - minCell.Y + 1) * (maxCell.Z - minCell.Z + 1);
+
+	// a huge query visits the occupied cells instead of every cell of the query
+	if (numQueryCells > Cells.Num())
+	{
+		for (const auto& cell : Cells)
+		{
+			if (cell.Key.X >= minCell.X && cell.Key.X <= maxCell.X &&
+				cell.Key.Y >= minCell.Y && cell.Key.Y <= maxCell.Y &&
+				cell.Key.Z >= minCell.Z && cell.Key.Z <= maxCell.Z)
+			{
+				for (const int32 id : cell.Value)
+				{
+					const FElement& element = Elements[id];
+
+					if (Box.ComputeSquaredDistanceToPoint(element.Center) <= FMath::Square(element.Radius))
+					{
+						OutIds.Add(id);
+					}
+				}
+			}
+		}
+
+		return;
+	}
+
+	for (int32 z = minCell.Z; z <= maxCell.Z; ++z)
+	{
+		for (int32 y = minCell.Y; y <= maxCell.Y; ++y)
+		{
+			for (int32 x = minCell.X; x <= maxCell.X; ++x)
+			{
+				const TArray<int32>* cell = Cells.Find(FIntVector(x, y, z));
+
+				if (!cell)
+				{
+					continue;
+				}
+
+				for (const int32 id : *cell)
+				{
+					const FElement& element = Elements[id];
+
+					if (Box.ComputeSquaredDistanceToPoint(element.Center) <= FMath::Square(element.Radius))
+					{
+						OutIds.Add(id);
+					}
+				}
+			}
+		}
+	}
+}
+
+FIntVector FBreakableGrid::GetCell(const FVector& Location) const
+{
+	return FIntVector(
+		FMath::FloorToInt32(Location.X / CellSize),
+		FMath::FloorToInt32(Location.Y / CellSize),
+		FMath::FloorToInt32(Location.Z / CellSize));
+}
\ No newline at end of file
@@ -0,0 +1,600 @@
+#include "Subsystems/BreakableSubsystem.h"
+
+#include <Engine/World.h>
+#include <Components/PrimitiveComponent.h>
+#include <HAL/IConsoleManager.h>
+#include <Misc/App.h>
+#include <Misc/FileHelper.h>
+#include <Misc/Paths.h>
+
+#include "Breakables/BreakableActorInterface.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Breaks Per Frame"), STAT_BreaksPerFrame, STATGROUP_Breakables);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pending Hits"), STAT_PendingBreakableHits, STATGROUP_Breakables);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Queued Supported Breaks"), STAT_QueuedSupportedBreaks, STATGROUP_Breakables);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Registered Items"), STAT_BreakableGridItems, STATGROUP_Breakables);
+DECLARE_CYCLE_STAT(TEXT("Hit Pass"), STAT_BreakableHitPass, STATGROUP_Breakables);
+
+CSV_DEFINE_CATEGORY(Breakables, true);
+
+static TAutoConsoleVariable<float> CVarBreakableRearmCooldown(
+	TEXT("gravity.Breakable.RearmCooldown"),
+	0.1f,
+	TEXT("Seconds a breakable or instance ignores hits that cannot break it on their own after a hit which did not break it."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBreakableGridCellSize(
+	TEXT("gravity.Breakable.GridCellSize"),
+	2000.0f,
+	TEXT("Edge length in cm of the cells of the spatial index for area-of-effect breaks, read when the world is created."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarBreakablePropagationsPerFrame(
+	TEXT("gravity.Breakable.PropagationsPerFrame"),
+	8,
+	TEXT("Number of items which lost their support that are broken per frame."),
+	ECVF_Default);
+
+static FAutoConsoleCommandWithWorldAndArgs CmdBreakableBenchmark(
+	TEXT("gravity.Breakable.Benchmark"),
+	TEXT("Breaks registered breakables over several frames and writes the frame time percentiles to Saved/Profiling/Breakables. Arguments: NumBreaks (100), BreaksPerFrame (4)."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+	{
+		UBreakableSubsystem* breakableSubsystem = World ? World->GetSubsystem<UBreakableSubsystem>() : nullptr;
+
+		if (!breakableSubsystem)
+		{
+			UE_LOG(LogGravityBreakableObject, Warning, TEXT("The breakable benchmark needs a game world."));
+			return;
+		}
+
+		const int32 numBreaks = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 100;
+		const int32 breaksPerFrame = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 4;
+
+		breakableSubsystem->StartBenchmark(numBreaks, breaksPerFrame);
+	}));
+
+void UBreakableSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Grid = FBreakableGrid(FMath::Max(CVarBreakableGridCellSize.GetValueOnGameThread(), 100.0f));
+}
+
+bool UBreakableSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UBreakableSubsystem::QueueHit(ABreakableActorInterface* Breakable, UPrimitiveComponent* MyComponent, UPrimitiveComponent* OtherComponent, const FVector& NormalImpulse, const FHitResult& Hit)
+{
+	const FBreakableHitKey hitKey(Breakable, Hit.MyItem);
+
+	const double* rearmTime = RearmTimes.Find(hitKey);
+
+	if (rearmTime && *rearmTime > GetWorld()->GetTimeSeconds() && NormalImpulse.SizeSquared() < FMath::Square(Breakable->GetBreakThreshold()))
+	{
+		return;
+	}
+
+	if (const int32* pendingHitIndex = PendingHitIndices.Find(hitKey))
+	{
+		FBreakableHit& pendingHit = PendingHits[*pendingHitIndex];
+
+		if (NormalImpulse.SizeSquared() > pendingHit.NormalImpulse.SizeSquared())
+		{
+			pendingHit.MyComponent = MyComponent;
+			pendingHit.OtherComponent = OtherComponent;
+			pendingHit.NormalImpulse = NormalImpulse;
+			pendingHit.Hit = Hit;
+		}
+
+		return;
+	}
+
+	PendingHitIndices.Add(hitKey, PendingHits.Num());
+
+	FBreakableHit& pendingHit = PendingHits.AddDefaulted_GetRef();
+	pendingHit.Breakable = Breakable;
+	pendingHit.MyComponent = MyComponent;
+	pendingHit.OtherComponent = OtherComponent;
+	pendingHit.NormalImpulse = NormalImpulse;
+	pendingHit.Hit = Hit;
+}
+
+void UBreakableSubsystem::RequestFlush(ABreakableActorInterface* Breakable)
+{
+	PendingFlushes.AddUnique(Breakable);
+}
+
+void UBreakableSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const double time = GetWorld()->GetTimeSeconds();
+
+	// tickable objects tick after the tick groups, all hits of the physics steps of this frame are known at this point
+	if (PendingHits.Num() > 0)
+	{
+		ProcessPendingHits(time);
+	}
+
+	if (IsBenchmarkRunning())
+	{
+		UpdateBenchmark();
+	}
+
+	// supported items of the breaks of the last frames, also the breaks of this frame's pass are queued here
+	if (SupportedBreakQueueHead < SupportedBreakQueue.Num())
+	{
+		ProcessSupportedBreaks();
+	}
+
+	// breaks which were triggered outside of the batched pass, e.g. by a blueprint, are flushed here as well
+	for (const TWeakObjectPtr<ABreakableActorInterface>& pendingFlush : PendingFlushes)
+	{
+		if (ABreakableActorInterface* breakable = pendingFlush.Get())
+		{
+			breakable->OnFlushBreaks();
+		}
+	}
+
+	PendingFlushes.Reset();
+
+	SET_DWORD_STAT(STAT_BreaksPerFrame, NumBreaksThisFrame);
+	SET_DWORD_STAT(STAT_PendingBreakableHits, PendingHits.Num());
+	SET_DWORD_STAT(STAT_QueuedSupportedBreaks, SupportedBreakQueue.Num() - SupportedBreakQueueHead);
+	SET_DWORD_STAT(STAT_BreakableGridItems, GridItems.Num());
+
+	CSV_CUSTOM_STAT(Breakables, Breaks, NumBreaksThisFrame, ECsvCustomStatOp::Set);
+
+	NumBreaksThisFrame = 0;
+
+	for (auto rearmTimeIt = RearmTimes.CreateIterator(); rearmTimeIt; ++rearmTimeIt)
+	{
+		if (rearmTimeIt.Value() <= time)
+		{
+			rearmTimeIt.RemoveCurrent();
+		}
+	}
+}
+
+TStatId UBreakableSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UBreakableSubsystem, STATGROUP_Tickables);
+}
+
+void UBreakableSubsystem::ProcessPendingHits(double Time)
+{
+	SCOPE_CYCLE_COUNTER(STAT_BreakableHitPass);
+	CSV_SCOPED_TIMING_STAT(Breakables, HitPass);
+
+	// breaking can spawn debris which hits other breakables, their hits are queued for the next frame
+	TArray<FBreakableHit> pendingHits = MoveTemp(PendingHits);
+
+	PendingHits.Reset();
+	PendingHitIndices.Reset();
+
+	const float rearmCooldown = CVarBreakableRearmCooldown.GetValueOnGameThread();
+
+	for (const FBreakableHit& pendingHit : pendingHits)
+	{
+		ABreakableActorInterface* breakable = pendingHit.Breakable.Get();
+		UPrimitiveComponent* myComponent = pendingHit.MyComponent.Get();
+
+		// the breakable could have been destroyed by an earlier hit of the batch
+		if (!breakable || !myComponent)
+		{
+			continue;
+		}
+
+		const bool bIsBroken = breakable->ProcessHit(myComponent, pendingHit.OtherComponent.Get(), pendingHit.NormalImpulse, pendingHit.Hit);
+
+		if (!bIsBroken && rearmCooldown > 0.0f)
+		{
+			RearmTimes.Add(FBreakableHitKey(breakable, pendingHit.Hit.MyItem), Time + rearmCooldown);
+		}
+	}
+}
+
+void UBreakableSubsystem::QueueSupportedBreak(ABreakableActorInterface* Breakable, int32 Item)
+{
+	SupportedBreakQueue.Emplace(Breakable, Item);
+}
+
+void UBreakableSubsystem::ProcessSupportedBreaks()
+{
+	const int32 numBreaks = FMath::Max(CVarBreakablePropagationsPerFrame.GetValueOnGameThread(), 1);
+
+	int32 numProcessed = 0;
+
+	// breaking an item queues its supported items at the end, they are processed in a later frame once the budget runs out
+	while (numProcessed < numBreaks && SupportedBreakQueueHead < SupportedBreakQueue.Num())
+	{
+		const TPair<TWeakObjectPtr<ABreakableActorInterface>, int32> supportedBreak = SupportedBreakQueue[SupportedBreakQueueHead++];
+
+		ABreakableActorInterface* breakable = supportedBreak.Key.Get();
+
+		// items which are already broken do not count against the budget
+		if (breakable && breakable->BreakItem(supportedBreak.Value))
+		{
+			++numProcessed;
+		}
+	}
+
+	if (SupportedBreakQueueHead >= SupportedBreakQueue.Num())
+	{
+		SupportedBreakQueue.Reset();
+		SupportedBreakQueueHead = 0;
+	}
+}
+
+void UBreakableSubsystem::StoreBrokenState(const FGuid& BreakableGuid, TBitArray<>&& BrokenItems)
+{
+	BrokenStates.Add(BreakableGuid, MoveTemp(BrokenItems));
+}
+
+void UBreakableSubsystem::RegisterBreakable(ABreakableActorInterface* Breakable)
+{
+	TArray<FBreakableItem> breakableItems;
+	Breakable->GetBreakableItems(breakableItems);
+
+	TArray<int32>& breakableItemIndices = BreakableGridItemIndices.FindOrAdd(FObjectKey(Breakable));
+
+	for (const FBreakableItem& breakableItem : breakableItems)
+	{
+		const FBreakableHitKey itemKey(Breakable, breakableItem.Item);
+
+		if (GridItemIndices.Contains(itemKey))
+		{
+			continue;
+		}
+
+		FBreakableGridItem gridItem;
+		gridItem.Breakable = Breakable;
+		gridItem.Component = breakableItem.Component;
+		gridItem.Item = breakableItem.Item;
+		gridItem.Bounds = breakableItem.Bounds;
+		gridItem.bIsMovable = breakableItem.bIsMovable;
+
+		const int32 itemIndex = GridItems.Add(gridItem);
+
+		GridItemIndices.Add(itemKey, itemIndex);
+		breakableItemIndices.Add(itemIndex);
+
+		if (gridItem.bIsMovable)
+		{
+			MovableGridItems.Add(itemIndex);
+		}
+		else
+		{
+			Grid.Add(itemIndex, gridItem.Bounds.Center, static_cast<float>(gridItem.Bounds.W));
+		}
+	}
+}
+
+void UBreakableSubsystem::UnregisterBreakable(ABreakableActorInterface* Breakable)
+{
+	TArray<int32> breakableItemIndices;
+
+	if (!BreakableGridItemIndices.RemoveAndCopyValue(FObjectKey(Breakable), breakableItemIndices))
+	{
+		return;
+	}
+
+	for (const int32 itemIndex : breakableItemIndices)
+	{
+		GridItemIndices.Remove(FBreakableHitKey(Breakable, GridItems[itemIndex].Item));
+
+		Grid.Remove(itemIndex);
+		MovableGridItems.RemoveSingleSwap(itemIndex);
+		GridItems.RemoveAt(itemIndex);
+	}
+}
+
+void UBreakableSubsystem::NotifyItemBroken(ABreakableActorInterface* Breakable, int32 Item)
+{
+	++NumBreaksThisFrame;
+
+	int32 itemIndex = INDEX_NONE;
+
+	if (GridItemIndices.RemoveAndCopyValue(FBreakableHitKey(Breakable, Item), itemIndex))
+	{
+		if (TArray<int32>* breakableItemIndices = BreakableGridItemIndices.Find(FObjectKey(Breakable)))
+		{
+			breakableItemIndices->RemoveSingleSwap(itemIndex);
+		}
+
+		Grid.Remove(itemIndex);
+		MovableGridItems.RemoveSingleSwap(itemIndex);
+		GridItems.RemoveAt(itemIndex);
+	}
+}
+
+int32 UBreakableSubsystem::BreakInRadius(const FVector& Origin, float Radius, float Impulse, TArray<FBreakableItemImpulse>* OutImpulses)
+{
+	TArray<TPair<int32, FSphere>> gridItems;
+	QueryGridItems(FBox(Origin - FVector(Radius), Origin + FVector(Radius)), gridItems);
+
+	TArray<FBreakableItemImpulse> impulses;
+	impulses.Reserve(gridItems.Num());
+
+	for (const TPair<int32, FSphere>& gridItem : gridItems)
+	{
+		const FSphere& itemBounds = gridItem.Value;
+		const FVector originToItem = itemBounds.Center - Origin;
+		const double distance = FMath::Max(originToItem.Size() - itemBounds.W, 0.0);
+
+		if (distance > Radius)
+		{
+			continue;
+		}
+
+		const FBreakableGridItem& breakableItem = GridItems[gridItem.Key];
+
+		FBreakableItemImpulse& itemImpulse = impulses.AddDefaulted_GetRef();
+		itemImpulse.Breakable = breakableItem.Breakable;
+		itemImpulse.Item = breakableItem.Item;
+		itemImpulse.Impulse = originToItem.GetSafeNormal(UE_SMALL_NUMBER, FVector::UpVector) * Impulse * (1.0 - distance / FMath::Max(Radius, UE_SMALL_NUMBER));
+	}
+
+	const int32 numBroken = ApplyItemImpulses(impulses);
+
+	if (OutImpulses)
+	{
+		*OutImpulses = MoveTemp(impulses);
+	}
+
+	return numBroken;
+}
+
+int32 UBreakableSubsystem::BreakInBox(const FBox& Box, const FVector& Impulse, TArray<FBreakableItemImpulse>* OutImpulses)
+{
+	TArray<TPair<int32, FSphere>> gridItems;
+	QueryGridItems(Box, gridItems);
+
+	TArray<FBreakableItemImpulse> impulses;
+	impulses.Reserve(gridItems.Num());
+
+	for (const TPair<int32, FSphere>& gridItem : gridItems)
+	{
+		const FBreakableGridItem& breakableItem = GridItems[gridItem.Key];
+
+		FBreakableItemImpulse& itemImpulse = impulses.AddDefaulted_GetRef();
+		itemImpulse.Breakable = breakableItem.Breakable;
+		itemImpulse.Item = breakableItem.Item;
+		itemImpulse.Impulse = Impulse;
+	}
+
+	const int32 numBroken = ApplyItemImpulses(impulses);
+
+	if (OutImpulses)
+	{
+		*OutImpulses = MoveTemp(impulses);
+	}
+
+	return numBroken;
+}
+
+int32 UBreakableSubsystem::BreakAlongSweep(const FVector& Start, const FVector& End, float Radius, float Impulse, TArray<FBreakableItemImpulse>* OutImpulses)
+{
+	FBox sweepBox(ForceInit);
+	sweepBox += Start;
+	sweepBox += End;
+
+	TArray<TPair<int32, FSphere>> gridItems;
+	QueryGridItems(sweepBox.ExpandBy(Radius), gridItems);
+
+	const FVector sweepDirection = (End - Start).GetSafeNormal(UE_SMALL_NUMBER, FVector::UpVector);
+
+	TArray<FBreakableItemImpulse> impulses;
+	impulses.Reserve(gridItems.Num());
+
+	for (const TPair<int32, FSphere>& gridItem : gridItems)
+	{
+		const FSphere& itemBounds = gridItem.Value;
+		const double distance = FMath::Max(FMath::PointDistToSegment(itemBounds.Center, Start, End) - itemBounds.W, 0.0);
+
+		if (distance > Radius)
+		{
+			continue;
+		}
+
+		const FBreakableGridItem& breakableItem = GridItems[gridItem.Key];
+
+		FBreakableItemImpulse& itemImpulse = impulses.AddDefaulted_GetRef();
+		itemImpulse.Breakable = breakableItem.Breakable;
+		itemImpulse.Item = breakableItem.Item;
+		itemImpulse.Impulse = sweepDirection * Impulse * (1.0 - distance / FMath::Max(Radius, UE_SMALL_NUMBER));
+	}
+
+	const int32 numBroken = ApplyItemImpulses(impulses);
+
+	if (OutImpulses)
+	{
+		*OutImpulses = MoveTemp(impulses);
+	}
+
+	return numBroken;
+}
+
+void UBreakableSubsystem::QueryGridItems(const FBox& Box, TArray<TPair<int32, FSphere>>& OutItems)
+{
+	GridQueryIds.Reset();
+	Grid.Query(Box, GridQueryIds);
+
+	OutItems.Reserve(GridQueryIds.Num() + MovableGridItems.Num());
+
+	for (const int32 itemIndex : GridQueryIds)
+	{
+		OutItems.Emplace(itemIndex, GridItems[itemIndex].Bounds);
+	}
+
+	// movable breakables are few, testing them directly is cheaper than keeping the grid up to date
+	for (const int32 itemIndex : MovableGridItems)
+	{
+		const UPrimitiveComponent* component = GridItems[itemIndex].Component.Get();
+
+		if (!component)
+		{
+			continue;
+		}
+
+		const FSphere itemBounds = component->Bounds.GetSphere();
+
+		if (Box.ComputeSquaredDistanceToPoint(itemBounds.Center) <= FMath::Square(itemBounds.W))
+		{
+			OutItems.Emplace(itemIndex, itemBounds);
+		}
+	}
+}
+
+int32 UBreakableSubsystem::ApplyItemImpulses(TArray<FBreakableItemImpulse>& Impulses)
+{
+	int32 numBroken = 0;
+
+	// the impulses are collected before any break because breaking removes items from the grid
+	for (FBreakableItemImpulse& itemImpulse : Impulses)
+	{
+		ABreakableActorInterface* breakable = itemImpulse.Breakable.Get();
+		const int32* itemIndex = breakable ? GridItemIndices.Find(FBreakableHitKey(breakable, itemImpulse.Item)) : nullptr;
+
+		// an earlier break of the pass can destroy the breakable
+		if (!itemIndex)
+		{
+			continue;
+		}
+
+		UPrimitiveComponent* component = GridItems[*itemIndex].Component.Get();
+
+		if (!component)
+		{
+			continue;
+		}
+
+		FHitResult hit(breakable, component, GridItems[*itemIndex].Bounds.Center, -itemImpulse.Impulse.GetSafeNormal());
+		hit.MyItem = itemImpulse.Item;
+		hit.Item = itemImpulse.Item;
+
+		itemImpulse.bIsBroken = breakable->ProcessHit(component, nullptr, itemImpulse.Impulse, hit);
+
+		numBroken += itemImpulse.bIsBroken ? 1 : 0;
+	}
+
+	return numBroken;
+}
+
+void UBreakableSubsystem::StartBenchmark(int32 NumBreaks, int32 BreaksPerFrame)
+{
+	if (IsBenchmarkRunning())
+	{
+		UE_LOG(LogGravityBreakableObject, Warning, TEXT("A breakable benchmark is already running."));
+		return;
+	}
+
+	BenchmarkBreaks.Reset();
+	BenchmarkResult = FBreakableBenchmarkResult();
+
+	for (const FBreakableGridItem& gridItem : GridItems)
+	{
+		BenchmarkBreaks.Emplace(gridItem.Breakable, gridItem.Item);
+	}
+
+	// a fixed seed breaks the same items in the same order on every run
+	FRandomStream randomStream(0);
+
+	for (int32 breakIndex = BenchmarkBreaks.Num() - 1; breakIndex > 0; --breakIndex)
+	{
+		BenchmarkBreaks.Swap(breakIndex, randomStream.RandRange(0, breakIndex));
+	}
+
+	BenchmarkBreaks.SetNum(FMath::Min(FMath::Max(NumBreaks, 0), BenchmarkBreaks.Num()));
+
+	if (BenchmarkBreaks.Num() == 0)
+	{
+		UE_LOG(LogGravityBreakableObject, Warning, TEXT("The breakable benchmark found no breakables to break."));
+		return;
+	}
+
+	BenchmarkBreakIndex = 0;
+	BenchmarkBreaksPerFrame = FMath::Max(BreaksPerFrame, 1);
+
+	// the debris of the last breaks keeps simulating, settling and despawning for a while
+	BenchmarkSettleFrames = 120;
+
+	BenchmarkFrameTimes.Reset();
+
+	CSV_EVENT(Breakables, TEXT("BenchmarkStart"));
+
+	UE_LOG(LogGravityBreakableObject, Display, TEXT("Breakable benchmark started with %d breaks, %d per frame."), BenchmarkBreaks.Num(), BenchmarkBreaksPerFrame);
+}
+
+void UBreakableSubsystem::UpdateBenchmark()
+{
+	// the first frame has no benchmark break before it
+	if (BenchmarkBreakIndex > 0)
+	{
+		BenchmarkFrameTimes.Emplace(static_cast<float>(FApp::GetDeltaTime() * 1000.0), static_cast<float>(FPlatformTime::ToMilliseconds(GGameThreadTime)));
+	}
+
+	if (BenchmarkBreakIndex >= BenchmarkBreaks.Num())
+	{
+		if (--BenchmarkSettleFrames <= 0)
+		{
+			FinishBenchmark();
+		}
+
+		return;
+	}
+
+	const int32 lastBreakIndex = FMath::Min(BenchmarkBreakIndex + BenchmarkBreaksPerFrame, BenchmarkBreaks.Num());
+
+	for (; BenchmarkBreakIndex < lastBreakIndex; ++BenchmarkBreakIndex)
+	{
+		if (ABreakableActorInterface* breakable = BenchmarkBreaks[BenchmarkBreakIndex].Key.Get())
+		{
+			breakable->BreakItem(BenchmarkBreaks[BenchmarkBreakIndex].Value);
+		}
+	}
+}
+
+void UBreakableSubsystem::FinishBenchmark()
+{
+	CSV_EVENT(Breakables, TEXT("BenchmarkEnd"));
+
+	for (const TPair<float, float>& benchmarkFrameTime : BenchmarkFrameTimes)
+	{
+		BenchmarkResult.FrameTimes.Add(benchmarkFrameTime.Key);
+		BenchmarkResult.GameThreadTimes.Add(benchmarkFrameTime.Value);
+	}
+
+	BenchmarkResult.FrameTimes.Sort();
+	BenchmarkResult.GameThreadTimes.Sort();
+
+	FString csv = TEXT("Percentile,FrameTimeMs,GameThreadTimeMs\n");
+
+	for (const int32 percentile : { 50, 90, 95, 99, 100 })
+	{
+		const float frameTime = BenchmarkResult.GetFrameTime(percentile);
+		const float gameThreadTime = BenchmarkResult.GetGameThreadTime(percentile);
+
+		csv += FString::Printf(TEXT("%d,%.3f,%.3f\n"), percentile, frameTime, gameThreadTime);
+
+		UE_LOG(LogGravityBreakableObject, Display, TEXT("Breakable benchmark p%d: frame %.3f ms, game thread %.3f ms."), percentile, frameTime, gameThreadTime);
+	}
+
+	const FString csvPath = FPaths::ProfilingDir() / TEXT("Breakables") / FString::Printf(TEXT("Benchmark-%s.csv"), *FDateTime::Now().ToString());
+
+	if (FFileHelper::SaveStringToFile(csv, *csvPath))
+	{
+		UE_LOG(LogGravityBreakableObject, Display, TEXT("Breakable benchmark finished after %d frames, results written to '%s'."), BenchmarkFrameTimes.Num(), *csvPath);
+	}
+	else
+	{
+		UE_LOG(LogGravityBreakableObject, Warning, TEXT("Failed to write the breakable benchmark results to '%s'."), *csvPath);
+	}
+
+	BenchmarkBreaks.Reset();
+	BenchmarkFrameTimes.Reset();
+	BenchmarkBreaksPerFrame = 0;
+}
\ No newline at end of file
@@ -0,0 +1,1249 @@
+#include "Subsystems/DebrisSubsystem.h"
+
+#include <Engine/World.h>
+#include <GameFramework/WorldSettings.h>
+#include <GameFramework/PlayerController.h>
+#include <Engine/StaticMesh.h>
+#include <Components/InstancedStaticMeshComponent.h>
+#include <Materials/MaterialParameterCollection.h>
+#include <Materials/MaterialParameterCollectionInstance.h>
+#include <HAL/IConsoleManager.h>
+#include <ProfilingDebugging/CsvProfiler.h>
+
+#include "Breakables/BreakableActorInterface.h"
+#include "Breakables/BreakableFractureData.h"
+#include "Breakables/DebrisStaticMeshActor.h"
+#include "Breakables/DebrisStaticMeshComponent.h"
+
+DEFINE_LOG_CATEGORY(LogGravityDebris)
+
+DECLARE_STATS_GROUP(TEXT("Debris"), STATGROUP_Debris, STATCAT_Advanced);
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Active Debris"), STAT_ActiveDebris, STATGROUP_Debris);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Simulating Debris"), STAT_SimulatingDebris, STATGROUP_Debris);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Total Debris Budget"), STAT_TotalDebrisBudget, STATGROUP_Debris);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Simulating Debris Budget"), STAT_SimulatingDebrisBudget, STATGROUP_Debris);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Free Debris Actors"), STAT_FreeDebrisActors, STATGROUP_Debris);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Settled Debris"), STAT_SettledDebris, STATGROUP_Debris);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Queued Debris Spawns"), STAT_QueuedDebrisSpawns, STATGROUP_Debris);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Discarded Debris Spawns"), STAT_DiscardedDebrisSpawns, STATGROUP_Debris);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Evicted Debris"), STAT_EvictedDebris, STATGROUP_Debris);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Dropped Debris Pieces"), STAT_DroppedDebris, STATGROUP_Debris);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Debris Bodies"), STAT_DebrisBodies, STATGROUP_Debris);
+DECLARE_CYCLE_STAT(TEXT("Debris Tick"), STAT_DebrisTick, STATGROUP_Debris);
+DECLARE_CYCLE_STAT(TEXT("Spawn Debris"), STAT_SpawnDebris, STATGROUP_Debris);
+
+CSV_DEFINE_CATEGORY(Debris, true);
+
+static TAutoConsoleVariable<int32> CVarDebrisPoolPrewarmActors(
+	TEXT("gravity.Debris.PoolPrewarmActors"),
+	16,
+	TEXT("Number of debris actors that are spawned into the pool at the begin of play."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarDebrisBoundsChecksPerFrame(
+	TEXT("gravity.Debris.BoundsChecksPerFrame"),
+	32,
+	TEXT("Number of debris pieces checked against KillZ and the world bounds per frame."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarDebrisMaxSimulating(
+	TEXT("gravity.Debris.MaxSimulating"),
+	128,
+	TEXT("Maximum number of debris pieces with simulated bodies, 0 disables the limit."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarDebrisMaxTotal(
+	TEXT("gravity.Debris.MaxTotal"),
+	256,
+	TEXT("Maximum number of active debris pieces including frozen and despawning ones, 0 disables the limit."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarDebrisMaxEvictionsPerSpawn(
+	TEXT("gravity.Debris.MaxEvictionsPerSpawn"),
+	32,
+	TEXT("Maximum number of debris pieces evicted to make room for a single spawn, the spawn gets fewer pieces if this is not enough."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarDebrisEvictionMode(
+	TEXT("gravity.Debris.EvictionMode"),
+	0,
+	TEXT("How debris above the simulating budget is evicted.\n")
+	TEXT("0: fast despawn\n")
+	TEXT("1: freeze to kinematic and despawn after the lifetime"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarDebrisFastDespawnDuration(
+	TEXT("gravity.Debris.FastDespawnDuration"),
+	0.25f,
+	TEXT("Duration of the despawn sequence of evicted debris."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarDebrisInstanceSettledDebris(
+	TEXT("gravity.Debris.InstanceSettledDebris"),
+	1,
+	TEXT("If enabled, debris that fell asleep is rendered by instanced components without physics bodies until it despawned."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarDebrisSpawnPiecesPerFrame(
+	TEXT("gravity.Debris.SpawnPiecesPerFrame"),
+	32,
+	TEXT("Maximum number of debris pieces spawned from the spawn queue per frame, at least one spawn is drained per frame."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarDebrisSpawnTimeBudgetMs(
+	TEXT("gravity.Debris.SpawnTimeBudgetMs"),
+	1.0f,
+	TEXT("Time in milliseconds the spawn queue may spend per frame, at least one spawn is drained per frame."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarDebrisSpawnQueueMaxDelay(
+	TEXT("gravity.Debris.SpawnQueueMaxDelay"),
+	0.5f,
+	TEXT("Queued debris spawns older than this many seconds are discarded, debris appearing late looks wrong."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarDebrisPrefetchRadius(
+	TEXT("gravity.Debris.PrefetchRadius"),
+	5000.0f,
+	TEXT("Debris meshes of a breakable are streamed in when the player or a prefetch source comes closer than this radius."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarDebrisPrefetchReleaseRadius(
+	TEXT("gravity.Debris.PrefetchReleaseRadius"),
+	7500.0f,
+	TEXT("Debris meshes of a breakable are released when the player and all prefetch sources are farther away than this radius."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarDebrisPrefetchUpdatesPerFrame(
+	TEXT("gravity.Debris.PrefetchUpdatesPerFrame"),
+	64,
+	TEXT("Number of breakables checked against the prefetch radius per frame."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarDebrisPoolMaxFreeActors(
+	TEXT("gravity.Debris.PoolMaxFreeActors"),
+	64,
+	TEXT("Maximum number of inactive debris actors kept in the pool, released actors above this limit are destroyed."),
+	ECVF_Default);
+
+static bool IsSimulatingState(EDebrisState State)
+{
+	return State == EDebrisState::Simulating || State == EDebrisState::Sleeping;
+}
+
+bool UDebrisSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UDebrisSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// the despawn fade runs in the debris materials, they only need the current time
+	if (UMaterialParameterCollection* despawnParameterCollection = DespawnParameterCollection.LoadSynchronous())
+	{
+		DespawnParameterCollectionInstance = InWorld.GetParameterCollectionInstance(despawnParameterCollection);
+	}
+
+	// the fallback debris is always resident, it is spawned when a break happens before the fracture data of the breakable finished streaming
+	LoadedFallbackFractureData = FallbackFractureData.LoadSynchronous();
+
+	if (LoadedFallbackFractureData)
+	{
+		LoadedFallbackFractureData->LoadStaticMeshes();
+	}
+	else if (!FallbackFractureData.IsNull())
+	{
+		UE_LOG(LogGravityDebris, Warning, TEXT("Failed to load the fallback fracture data '%s'."), *FallbackFractureData.ToString());
+	}
+
+	const int32 numPrewarmActors = FMath::Max(CVarDebrisPoolPrewarmActors.GetValueOnGameThread(), 0);
+
+	FreeDebrisActors.Reserve(numPrewarmActors);
+
+	for (int32 actorIndex = 0; actorIndex < numPrewarmActors; ++actorIndex)
+	{
+		ADebrisStaticMeshActor* debrisActor = SpawnPooledActor();
+
+		if (!debrisActor)
+		{
+			break;
+		}
+
+		// the fracture data of the breakables is streamed in later, only the fallback meshes are known at this point
+		if (LoadedFallbackFractureData)
+		{
+			debrisActor->PrewarmDebris(*LoadedFallbackFractureData);
+		}
+
+		NumDebrisBodies += debrisActor->GetNumDebris();
+
+		FreeDebrisActors.Add(debrisActor);
+	}
+
+	// one actor keeps the fallback meshes, the other pre-warmed actors can take the meshes of the streamed in fractures
+	if (LoadedFallbackFractureData && FreeDebrisActors.Num() > 0)
+	{
+		PrewarmedFractureActors.Add(LoadedFallbackFractureData.Get(), FreeDebrisActors[0].Get());
+	}
+
+	UE_LOG(LogGravityDebris, Log, TEXT("Pre-warmed %d debris actors."), FreeDebrisActors.Num());
+}
+
+void UDebrisSubsystem::Deinitialize()
+{
+	for (auto& fracturePrefetch : FracturePrefetches)
+	{
+		if (fracturePrefetch.Value.StreamingHandle.IsValid())
+		{
+			fracturePrefetch.Value.StreamingHandle->CancelHandle();
+		}
+	}
+
+	FracturePrefetches.Reset();
+	PrefetchEntries.Reset();
+	PrewarmedFractureActors.Reset();
+
+	Super::Deinitialize();
+}
+
+void UDebrisSubsystem::RegisterBreakable(ABreakableActorInterface* Breakable)
+{
+	UBreakableFractureData* fractureData = Breakable ? Breakable->GetFractureData() : nullptr;
+
+	if (fractureData)
+	{
+		FBreakablePrefetchEntry& prefetchEntry = PrefetchEntries.AddDefaulted_GetRef();
+		prefetchEntry.Breakable = Breakable;
+		prefetchEntry.FractureData = fractureData;
+	}
+}
+
+void UDebrisSubsystem::UnregisterBreakable(ABreakableActorInterface* Breakable)
+{
+	const int32 entryIndex = PrefetchEntries.IndexOfByPredicate([Breakable](const FBreakablePrefetchEntry& PrefetchEntry) { return PrefetchEntry.Breakable == Breakable; });
+
+	if (entryIndex != INDEX_NONE)
+	{
+		if (PrefetchEntries[entryIndex].bIsInRange)
+		{
+			ReleaseFractureReference(PrefetchEntries[entryIndex].FractureData.Get());
+		}
+
+		PrefetchEntries.RemoveAtSwap(entryIndex);
+	}
+}
+
+void UDebrisSubsystem::AddPrefetchSource(AActor* Source)
+{
+	PrefetchSources.AddUnique(Source);
+}
+
+void UDebrisSubsystem::RemovePrefetchSource(AActor* Source)
+{
+	PrefetchSources.RemoveSwap(Source);
+}
+
+void UDebrisSubsystem::UpdatePrefetch()
+{
+	TArray<FVector, TInlineAllocator<8>> sourceLocations;
+
+	FVector viewLocation;
+
+	if (GetViewLocation(viewLocation))
+	{
+		sourceLocations.Add(viewLocation);
+	}
+
+	PrefetchSources.RemoveAllSwap([](const TWeakObjectPtr<AActor>& Source) { return !Source.IsValid(); });
+
+	for (const TWeakObjectPtr<AActor>& source : PrefetchSources)
+	{
+		sourceLocations.Add(source->GetActorLocation());
+	}
+
+	const float prefetchRadius = CVarDebrisPrefetchRadius.GetValueOnGameThread();
+	const float prefetchRadiusSquared = FMath::Square(prefetchRadius);
+
+	// the release radius is larger to avoid loading and unloading when a source moves along the prefetch radius
+	const float releaseRadiusSquared = FMath::Square(FMath::Max(CVarDebrisPrefetchReleaseRadius.GetValueOnGameThread(), prefetchRadius));
+
+	const int32 numUpdates = FMath::Min(CVarDebrisPrefetchUpdatesPerFrame.GetValueOnGameThread(), PrefetchEntries.Num());
+
+	for (int32 updateIndex = 0; updateIndex < numUpdates; ++updateIndex)
+	{
+		if (PrefetchCursor >= PrefetchEntries.Num())
+		{
+			PrefetchCursor = 0;
+		}
+
+		FBreakablePrefetchEntry& prefetchEntry = PrefetchEntries[PrefetchCursor++];
+
+		const ABreakableActorInterface* breakable = prefetchEntry.Breakable.Get();
+
+		if (!breakable)
+		{
+			continue;
+		}
+
+		const FVector breakableLocation = breakable->GetActorLocation();
+
+		float distanceSquared = TNumericLimits<float>::Max();
+
+		for (const FVector& sourceLocation : sourceLocations)
+		{
+			distanceSquared = FMath::Min(distanceSquared, static_cast<float>(FVector::DistSquared(sourceLocation, breakableLocation)));
+		}
+
+		if (!prefetchEntry.bIsInRange && distanceSquared <= prefetchRadiusSquared)
+		{
+			prefetchEntry.bIsInRange = true;
+
+			AddFractureReference(prefetchEntry.FractureData.Get());
+		}
+		else if (prefetchEntry.bIsInRange && distanceSquared > releaseRadiusSquared)
+		{
+			prefetchEntry.bIsInRange = false;
+
+			ReleaseFractureReference(prefetchEntry.FractureData.Get());
+		}
+	}
+}
+
+void UDebrisSubsystem::AddFractureReference(UBreakableFractureData* FractureData)
+{
+	if (!FractureData)
+	{
+		return;
+	}
+
+	FFracturePrefetch& fracturePrefetch = FracturePrefetches.FindOrAdd(FractureData);
+
+	if (fracturePrefetch.NumReferences++ > 0)
+	{
+		return;
+	}
+
+	TArray<FSoftObjectPath> staticMeshPaths;
+	FractureData->GetStaticMeshPaths(staticMeshPaths);
+
+	fracturePrefetch.StreamingHandle = StreamableManager.RequestAsyncLoad(MoveTemp(staticMeshPaths),
+		FStreamableDelegate::CreateUObject(this, &UDebrisSubsystem::OnFractureDataLoaded, TWeakObjectPtr<UBreakableFractureData>(FractureData)));
+}
+
+void UDebrisSubsystem::ReleaseFractureReference(UBreakableFractureData* FractureData)
+{
+	FFracturePrefetch* fracturePrefetch = FractureData ? FracturePrefetches.Find(FractureData) : nullptr;
+
+	if (!fracturePrefetch || --fracturePrefetch->NumReferences > 0)
+	{
+		return;
+	}
+
+	if (fracturePrefetch->StreamingHandle.IsValid())
+	{
+		fracturePrefetch->StreamingHandle->CancelHandle();
+	}
+
+	FractureData->ReleaseStaticMeshes();
+
+	FracturePrefetches.Remove(FractureData);
+	PrewarmedFractureActors.Remove(FractureData);
+}
+
+void UDebrisSubsystem::OnFractureDataLoaded(TWeakObjectPtr<UBreakableFractureData> FractureData)
+{
+	if (FractureData.IsValid() && FracturePrefetches.Contains(FractureData.Get()))
+	{
+		FractureData->ResolveStaticMeshes();
+
+		// the meshes are applied now and not when the breakable breaks, changing the mesh of a pooled component recreates its body
+		PrewarmFractureData(*FractureData);
+	}
+}
+
+void UDebrisSubsystem::PrewarmFractureData(const UBreakableFractureData& FractureData)
+{
+	// pooled actors can be destroyed from the outside, e.g. by a level transition
+	FreeDebrisActors.RemoveAllSwap([](const TObjectPtr<ADebrisStaticMeshActor>& DebrisActor) { return !IsValid(DebrisActor); });
+
+	// the reservation is dropped when the actor leaves the pool, a reserved actor is always free
+	ADebrisStaticMeshActor* debrisActor = nullptr;
+
+	if (const TWeakObjectPtr<ADebrisStaticMeshActor>* prewarmedActor = PrewarmedFractureActors.Find(&FractureData))
+	{
+		debrisActor = prewarmedActor->Get();
+
+		if (debrisActor && debrisActor->HasDebrisMeshes(FractureData))
+		{
+			return;
+		}
+	}
+
+	// an actor holding the meshes of another loaded fracture is never overwritten
+	if (!debrisActor)
+	{
+		for (const TObjectPtr<ADebrisStaticMeshActor>& freeActor : FreeDebrisActors)
+		{
+			if (!IsPrewarmedActor(freeActor))
+			{
+				debrisActor = freeActor;
+				break;
+			}
+		}
+	}
+
+	if (!debrisActor && FreeDebrisActors.Num() < CVarDebrisPoolMaxFreeActors.GetValueOnGameThread())
+	{
+		debrisActor = SpawnPooledActor();
+
+		if (debrisActor)
+		{
+			FreeDebrisActors.Add(debrisActor);
+		}
+	}
+
+	if (!debrisActor)
+	{
+		UE_LOG(LogGravityDebris, Verbose, TEXT("Debris pool is full, the fracture data '%s' is not pre-warmed."), *FractureData.GetName());
+		return;
+	}
+
+	const int32 numDebrisBodies = debrisActor->GetNumDebris();
+
+	debrisActor->PrewarmDebris(FractureData);
+
+	NumDebrisBodies += debrisActor->GetNumDebris() - numDebrisBodies;
+
+	PrewarmedFractureActors.Add(&FractureData, debrisActor);
+}
+
+bool UDebrisSubsystem::IsPrewarmedActor(const ADebrisStaticMeshActor* DebrisActor) const
+{
+	for (const auto& prewarmedFractureActor : PrewarmedFractureActors)
+	{
+		if (prewarmedFractureActor.Value.Get() == DebrisActor)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void UDebrisSubsystem::RemovePrewarmedActor(const ADebrisStaticMeshActor* DebrisActor)
+{
+	for (auto prewarmedFractureActorIt = PrewarmedFractureActors.CreateIterator(); prewarmedFractureActorIt; ++prewarmedFractureActorIt)
+	{
+		if (prewarmedFractureActorIt.Value().Get() == DebrisActor || !prewarmedFractureActorIt.Value().IsValid())
+		{
+			prewarmedFractureActorIt.RemoveCurrent();
+		}
+	}
+}
+
+ADebrisStaticMeshActor* UDebrisSubsystem::SpawnDebris(const FDebrisSpawnParameters& SpawnParameters)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SpawnDebris);
+	CSV_SCOPED_TIMING_STAT(Debris, SpawnDebris);
+
+	int32 numDebris = 0;
+
+	for (const FDebrisPieceParameters& piece : SpawnParameters.Pieces)
+	{
+		if (piece.StaticMesh)
+		{
+			++numDebris;
+		}
+	}
+
+	if (numDebris == 0)
+	{
+		return nullptr;
+	}
+
+	const double time = GetWorld()->GetTimeSeconds();
+
+	const int32 numAllowedDebris = ApplyDebrisBudget(numDebris, time);
+
+	INC_DWORD_STAT_BY(STAT_DroppedDebris, numDebris - numAllowedDebris);
+
+	if (numAllowedDebris == 0)
+	{
+		return nullptr;
+	}
+
+	const FDebrisSpawnParameters* spawnParameters = &SpawnParameters;
+	FDebrisSpawnParameters reducedSpawnParameters;
+
+	if (numAllowedDebris < numDebris)
+	{
+		// the budget is exhausted, keep only the largest pieces
+		reducedSpawnParameters = SpawnParameters;
+		reducedSpawnParameters.Pieces.RemoveAll([](const FDebrisPieceParameters& Piece) { return !Piece.StaticMesh; });
+		reducedSpawnParameters.Pieces.Sort([](const FDebrisPieceParameters& A, const FDebrisPieceParameters& B)
+		{
+			return A.StaticMesh->GetBounds().SphereRadius > B.StaticMesh->GetBounds().SphereRadius;
+		});
+		reducedSpawnParameters.Pieces.SetNum(numAllowedDebris);
+
+		spawnParameters = &reducedSpawnParameters;
+	}
+
+	ADebrisStaticMeshActor* debrisActor = AcquireActor(*spawnParameters, numAllowedDebris);
+
+	if (!debrisActor)
+	{
+		return nullptr;
+	}
+
+	ActivatedDebris.Reset();
+
+	// the actor creates components when it has not enough of them, each component keeps its physics body while it is pooled
+	const int32 numDebrisBodies = debrisActor->GetNumDebris();
+
+	debrisActor->ActivateDebris(*spawnParameters, ActivatedDebris);
+
+	NumDebrisBodies += debrisActor->GetNumDebris() - numDebrisBodies;
+
+	NumSimulatingDebris += ActivatedDebris.Num();
+
+	for (UDebrisStaticMeshComponent* debrisComponent : ActivatedDebris)
+	{
+		int32 recordIndex = INDEX_NONE;
+
+		if (FreeRecordIndices.Num() > 0)
+		{
+			recordIndex = FreeRecordIndices.Pop();
+		}
+		else
+		{
+			recordIndex = DebrisRecords.AddDefaulted();
+		}
+
+		FDebrisRecord& debrisRecord = DebrisRecords[recordIndex];
+		debrisRecord.Component = debrisComponent;
+		debrisRecord.Actor = debrisActor;
+		debrisRecord.Lifetime = spawnParameters->Lifetime;
+		debrisRecord.DespawnDuration = spawnParameters->DespawnDuration;
+		debrisRecord.SpawnTime = time;
+		debrisRecord.State = EDebrisState::Simulating;
+
+		debrisComponent->SetDebrisRecordIndex(recordIndex);
+
+		// pooled components keep their bindings
+		if (!debrisComponent->OnComponentSleep.IsAlreadyBound(this, &UDebrisSubsystem::OnDebrisSleep))
+		{
+			debrisComponent->OnComponentSleep.AddDynamic(this, &UDebrisSubsystem::OnDebrisSleep);
+			debrisComponent->OnComponentWake.AddDynamic(this, &UDebrisSubsystem::OnDebrisWake);
+		}
+	}
+
+	OnDebrisSpawned.Broadcast(ActivatedDebris);
+
+	return debrisActor;
+}
+
+void UDebrisSubsystem::QueueDebris(const FDebrisSpawnParameters& SpawnParameters)
+{
+	FDebrisSpawnRequest& spawnRequest = SpawnQueue.AddDefaulted_GetRef();
+	spawnRequest.SpawnParameters = SpawnParameters;
+	spawnRequest.RequestTime = GetWorld()->GetTimeSeconds();
+}
+
+void UDebrisSubsystem::DrainSpawnQueue(double Time)
+{
+	FVector viewLocation;
+
+	if (SpawnQueue.Num() > 1 && GetViewLocation(viewLocation))
+	{
+		SpawnQueue.StableSort([&viewLocation](const FDebrisSpawnRequest& A, const FDebrisSpawnRequest& B)
+		{
+			return FVector::DistSquared(A.SpawnParameters.Transform.GetLocation(), viewLocation) < FVector::DistSquared(B.SpawnParameters.Transform.GetLocation(), viewLocation);
+		});
+	}
+
+	const int32 maxSpawnedPieces = CVarDebrisSpawnPiecesPerFrame.GetValueOnGameThread();
+	const double timeBudget = CVarDebrisSpawnTimeBudgetMs.GetValueOnGameThread() * 0.001;
+	const double maxDelay = CVarDebrisSpawnQueueMaxDelay.GetValueOnGameThread();
+	const double startTime = FPlatformTime::Seconds();
+
+	int32 numSpawnedPieces = 0;
+	int32 numDrainedRequests = 0;
+	bool bHasSpawned = false;
+
+	for (; numDrainedRequests < SpawnQueue.Num(); ++numDrainedRequests)
+	{
+		const FDebrisSpawnRequest& spawnRequest = SpawnQueue[numDrainedRequests];
+
+		if (Time - spawnRequest.RequestTime > maxDelay)
+		{
+			INC_DWORD_STAT(STAT_DiscardedDebrisSpawns);
+			continue;
+		}
+
+		if (bHasSpawned && (numSpawnedPieces >= maxSpawnedPieces || FPlatformTime::Seconds() - startTime >= timeBudget))
+		{
+			break;
+		}
+
+		SpawnDebris(spawnRequest.SpawnParameters);
+
+		numSpawnedPieces += spawnRequest.SpawnParameters.Pieces.Num();
+		bHasSpawned = true;
+	}
+
+	SpawnQueue.RemoveAt(0, numDrainedRequests);
+}
+
+void UDebrisSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SCOPE_CYCLE_COUNTER(STAT_DebrisTick);
+	CSV_SCOPED_TIMING_STAT(Debris, Tick);
+
+	SET_DWORD_STAT(STAT_ActiveDebris, GetNumActiveDebris());
+	SET_DWORD_STAT(STAT_SimulatingDebris, NumSimulatingDebris);
+	SET_DWORD_STAT(STAT_TotalDebrisBudget, CVarDebrisMaxTotal.GetValueOnGameThread());
+	SET_DWORD_STAT(STAT_SimulatingDebrisBudget, CVarDebrisMaxSimulating.GetValueOnGameThread());
+	SET_DWORD_STAT(STAT_FreeDebrisActors, FreeDebrisActors.Num());
+	SET_DWORD_STAT(STAT_SettledDebris, NumSettledDebris);
+	SET_DWORD_STAT(STAT_QueuedDebrisSpawns, SpawnQueue.Num());
+	SET_DWORD_STAT(STAT_DebrisBodies, NumDebrisBodies);
+
+	CSV_CUSTOM_STAT(Debris, ActiveDebris, GetNumActiveDebris(), ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(Debris, SimulatingDebris, NumSimulatingDebris, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(Debris, SettledDebris, NumSettledDebris, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(Debris, DebrisBodies, NumDebrisBodies, ECsvCustomStatOp::Set);
+
+	const double time = GetWorld()->GetTimeSeconds();
+
+	if (DespawnParameterCollectionInstance)
+	{
+		DespawnParameterCollectionInstance->SetScalarParameterValue(DespawnTimeParameterName, static_cast<float>(time));
+	}
+
+	if (PrefetchEntries.Num() > 0)
+	{
+		UpdatePrefetch();
+	}
+
+	if (SpawnQueue.Num() > 0)
+	{
+		DrainSpawnQueue(time);
+	}
+
+	if (NumSettledDebris > 0)
+	{
+		UpdateSettledDebris(time);
+	}
+
+	// sleep events are dispatched while the physics results are synced, the components are only changed here
+	for (const FDebrisTimerWheel::FTimer& pendingDebris : PendingSettledDebris)
+	{
+		const FDebrisRecord& debrisRecord = DebrisRecords[pendingDebris.RecordIndex];
+
+		if (debrisRecord.Generation == pendingDebris.Generation && debrisRecord.State == EDebrisState::Sleeping && IsValid(debrisRecord.Component))
+		{
+			SettleDebris(pendingDebris.RecordIndex, time);
+		}
+	}
+
+	PendingSettledDebris.Reset();
+
+	if (GetNumActiveDebris() == 0)
+	{
+		return;
+	}
+
+	DueTimers.Reset();
+
+	DespawnTimers.Advance(time, DueTimers);
+
+	for (const FDebrisTimerWheel::FTimer& timer : DueTimers)
+	{
+		FDebrisRecord& debrisRecord = DebrisRecords[timer.RecordIndex];
+
+		// the debris woke up or despawned since the timer was scheduled
+		if (debrisRecord.Generation != timer.Generation)
+		{
+			continue;
+		}
+
+		if (!IsValid(debrisRecord.Component))
+		{
+			FinishDespawn(timer.RecordIndex);
+		}
+		else if (debrisRecord.State == EDebrisState::Sleeping || debrisRecord.State == EDebrisState::Frozen)
+		{
+			BeginDespawn(timer.RecordIndex, time, debrisRecord.DespawnDuration);
+		}
+		else if (debrisRecord.State == EDebrisState::Despawning)
+		{
+			FinishDespawn(timer.RecordIndex);
+		}
+	}
+
+	CheckWorldBounds();
+}
+
+void UDebrisSubsystem::CheckWorldBounds()
+{
+	const AWorldSettings* worldSettings = GetWorld()->GetWorldSettings(true);
+	const bool bCheckWorldBounds = worldSettings && worldSettings->AreWorldBoundsChecksEnabled();
+
+	const int32 numChecks = FMath::Min(CVarDebrisBoundsChecksPerFrame.GetValueOnGameThread(), DebrisRecords.Num());
+
+	for (int32 checkIndex = 0; checkIndex < numChecks; ++checkIndex)
+	{
+		if (WorldBoundsCheckCursor >= DebrisRecords.Num())
+		{
+			WorldBoundsCheckCursor = 0;
+		}
+
+		const int32 recordIndex = WorldBoundsCheckCursor++;
+
+		FDebrisRecord& debrisRecord = DebrisRecords[recordIndex];
+
+		if (!debrisRecord.Component)
+		{
+			continue;
+		}
+
+		if (!IsValid(debrisRecord.Component))
+		{
+			// the debris was destroyed from the outside, e.g. by a level transition
+			FinishDespawn(recordIndex);
+		}
+		else if (bCheckWorldBounds && debrisRecord.State == EDebrisState::Simulating && !debrisRecord.Component->IsInsideWorldBounds(*worldSettings))
+		{
+			// we are not in the world anymore, despawn the debris immediately
+			debrisRecord.Component->BeginDespawn();
+
+			FinishDespawn(recordIndex);
+		}
+	}
+}
+
+void UDebrisSubsystem::OnDebrisSleep(UPrimitiveComponent* SleepingComponent, FName BoneName)
+{
+	int32 recordIndex = INDEX_NONE;
+	FDebrisRecord* debrisRecord = FindRecord(SleepingComponent, recordIndex);
+
+	if (debrisRecord && debrisRecord->State == EDebrisState::Simulating)
+	{
+		debrisRecord->State = EDebrisState::Sleeping;
+		++debrisRecord->Generation;
+
+		if (CVarDebrisInstanceSettledDebris.GetValueOnGameThread() != 0)
+		{
+			PendingSettledDebris.Add({ recordIndex, debrisRecord->Generation, 0.0 });
+		}
+		else
+		{
+			DespawnTimers.Schedule(recordIndex, debrisRecord->Generation, GetWorld()->GetTimeSeconds() + debrisRecord->Lifetime);
+		}
+	}
+}
+
+void UDebrisSubsystem::OnDebrisWake(UPrimitiveComponent* WakingComponent, FName BoneName)
+{
+	int32 recordIndex = INDEX_NONE;
+	FDebrisRecord* debrisRecord = FindRecord(WakingComponent, recordIndex);
+
+	// the debris was moved, the pending despawn timer becomes stale
+	if (debrisRecord && debrisRecord->State == EDebrisState::Sleeping)
+	{
+		debrisRecord->State = EDebrisState::Simulating;
+		++debrisRecord->Generation;
+	}
+}
+
+bool UDebrisSubsystem::HoldDebris(UDebrisStaticMeshComponent* Component)
+{
+	int32 recordIndex = INDEX_NONE;
+	FDebrisRecord* debrisRecord = FindRecord(Component, recordIndex);
+
+	if (!debrisRecord || debrisRecord->State == EDebrisState::Despawning)
+	{
+		return false;
+	}
+
+	if (debrisRecord->State == EDebrisState::Held)
+	{
+		return true;
+	}
+
+	if (IsSimulatingState(debrisRecord->State))
+	{
+		--NumSimulatingDebris;
+	}
+
+	// pending despawn timers and settle requests of the debris become stale
+	debrisRecord->State = EDebrisState::Held;
+	++debrisRecord->Generation;
+
+	return true;
+}
+
+void UDebrisSubsystem::ReleaseHeldDebris(UDebrisStaticMeshComponent* Component)
+{
+	int32 recordIndex = INDEX_NONE;
+	FDebrisRecord* debrisRecord = FindRecord(Component, recordIndex);
+
+	if (debrisRecord && debrisRecord->State == EDebrisState::Held)
+	{
+		// the debris waits for its body to fall asleep again
+		debrisRecord->State = EDebrisState::Simulating;
+		++debrisRecord->Generation;
+
+		++NumSimulatingDebris;
+	}
+}
+
+FDebrisRecord* UDebrisSubsystem::FindRecord(const UPrimitiveComponent* Component, int32& OutRecordIndex)
+{
+	const UDebrisStaticMeshComponent* debrisComponent = Cast<UDebrisStaticMeshComponent>(Component);
+
+	if (!debrisComponent)
+	{
+		return nullptr;
+	}
+
+	OutRecordIndex = debrisComponent->GetDebrisRecordIndex();
+
+	if (DebrisRecords.IsValidIndex(OutRecordIndex) && DebrisRecords[OutRecordIndex].Component == debrisComponent)
+	{
+		return &DebrisRecords[OutRecordIndex];
+	}
+
+	return nullptr;
+}
+
+TStatId UDebrisSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UDebrisSubsystem, STATGROUP_Tickables);
+}
+
+void UDebrisSubsystem::BeginDespawn(int32 RecordIndex, double Time, float DespawnDuration)
+{
+	FDebrisRecord& debrisRecord = DebrisRecords[RecordIndex];
+
+	debrisRecord.Component->BeginDespawn();
+	debrisRecord.Component->SetDespawnFade(static_cast<float>(Time), DespawnDuration);
+
+	if (IsSimulatingState(debrisRecord.State))
+	{
+		--NumSimulatingDebris;
+	}
+
+	debrisRecord.State = EDebrisState::Despawning;
+	++debrisRecord.Generation;
+
+	DespawnTimers.Schedule(RecordIndex, debrisRecord.Generation, Time + DespawnDuration);
+}
+
+void UDebrisSubsystem::FreezeDebris(int32 RecordIndex, double Time)
+{
+	FDebrisRecord& debrisRecord = DebrisRecords[RecordIndex];
+
+	check(IsSimulatingState(debrisRecord.State));
+
+	debrisRecord.Component->SetSimulatePhysics(false);
+
+	--NumSimulatingDebris;
+
+	debrisRecord.State = EDebrisState::Frozen;
+	++debrisRecord.Generation;
+
+	DespawnTimers.Schedule(RecordIndex, debrisRecord.Generation, Time + debrisRecord.Lifetime);
+}
+
+int32 UDebrisSubsystem::ApplyDebrisBudget(int32 NumRequestedDebris, double Time)
+{
+	const int32 maxSimulatingDebris = CVarDebrisMaxSimulating.GetValueOnGameThread();
+	const int32 maxTotalDebris = CVarDebrisMaxTotal.GetValueOnGameThread();
+
+	const int32 numSimulatingOverBudget = maxSimulatingDebris > 0 ? NumSimulatingDebris + NumRequestedDebris - maxSimulatingDebris : 0;
+	const int32 numTotalOverBudget = maxTotalDebris > 0 ? GetNumActiveDebris() + NumRequestedDebris - maxTotalDebris : 0;
+
+	if (numSimulatingOverBudget > 0 || numTotalOverBudget > 0)
+	{
+		EvictDebris(FMath::Max(numSimulatingOverBudget, 0), FMath::Max(numTotalOverBudget, 0), Time);
+	}
+
+	int32 numAllowedDebris = NumRequestedDebris;
+
+	if (maxSimulatingDebris > 0)
+	{
+		numAllowedDebris = FMath::Min(numAllowedDebris, maxSimulatingDebris - NumSimulatingDebris);
+	}
+
+	if (maxTotalDebris > 0)
+	{
+		numAllowedDebris = FMath::Min(numAllowedDebris, maxTotalDebris - GetNumActiveDebris());
+	}
+
+	return FMath::Max(numAllowedDebris, 0);
+}
+
+void UDebrisSubsystem::EvictDebris(int32 NumSimulatingToEvict, int32 NumTotalToEvict, double Time)
+{
+	const int32 maxEvictions = CVarDebrisMaxEvictionsPerSpawn.GetValueOnGameThread();
+
+	NumSimulatingToEvict = FMath::Min(NumSimulatingToEvict, maxEvictions);
+	NumTotalToEvict = FMath::Min(NumTotalToEvict, maxEvictions);
+
+	FVector viewLocation;
+	const bool bHasViewLocation = GetViewLocation(viewLocation);
+
+	EvictionCandidates.Reset();
+
+	for (int32 recordIndex = 0; recordIndex < DebrisRecords.Num(); ++recordIndex)
+	{
+		const FDebrisRecord& debrisRecord = DebrisRecords[recordIndex];
+
+		if (IsValid(debrisRecord.Component) && debrisRecord.State != EDebrisState::Despawning && debrisRecord.State != EDebrisState::Held)
+		{
+			EvictionCandidates.Emplace(GetEvictionScore(debrisRecord, Time, bHasViewLocation ? &viewLocation : nullptr), recordIndex);
+		}
+	}
+
+	EvictionCandidates.Sort([](const TPair<float, int32>& A, const TPair<float, int32>& B) { return A.Key > B.Key; });
+
+	int32 candidateIndex = 0;
+	int32 numEvicted = 0;
+
+	// debris above the total budget is removed at once, a fast despawn would keep it in the budget for a while
+	for (; candidateIndex < EvictionCandidates.Num() && numEvicted < NumTotalToEvict; ++candidateIndex)
+	{
+		const int32 recordIndex = EvictionCandidates[candidateIndex].Value;
+
+		if (IsSimulatingState(DebrisRecords[recordIndex].State))
+		{
+			--NumSimulatingToEvict;
+		}
+
+		DebrisRecords[recordIndex].Component->BeginDespawn();
+
+		FinishDespawn(recordIndex);
+
+		++numEvicted;
+	}
+
+	const bool bFreezeDebris = CVarDebrisEvictionMode.GetValueOnGameThread() == 1;
+	const float fastDespawnDuration = CVarDebrisFastDespawnDuration.GetValueOnGameThread();
+
+	for (; candidateIndex < EvictionCandidates.Num() && NumSimulatingToEvict > 0; ++candidateIndex)
+	{
+		const int32 recordIndex = EvictionCandidates[candidateIndex].Value;
+
+		if (!IsSimulatingState(DebrisRecords[recordIndex].State))
+		{
+			continue;
+		}
+
+		if (bFreezeDebris)
+		{
+			FreezeDebris(recordIndex, Time);
+		}
+		else
+		{
+			BeginDespawn(recordIndex, Time, fastDespawnDuration);
+		}
+
+		--NumSimulatingToEvict;
+		++numEvicted;
+	}
+
+	INC_DWORD_STAT_BY(STAT_EvictedDebris, numEvicted);
+}
+
+bool UDebrisSubsystem::GetViewLocation(FVector& OutViewLocation) const
+{
+	const APlayerController* playerController = GetWorld()->GetFirstPlayerController();
+
+	if (!playerController)
+	{
+		return false;
+	}
+
+	FRotator viewRotation;
+	playerController->GetPlayerViewPoint(OutViewLocation, viewRotation);
+
+	return true;
+}
+
+float UDebrisSubsystem::GetEvictionScore(const FDebrisRecord& DebrisRecord, double Time, const FVector* ViewLocation) const
+{
+	// one point per second of age and per meter of distance to the viewer
+	float score = static_cast<float>(Time - DebrisRecord.SpawnTime);
+
+	if (ViewLocation)
+	{
+		score += FVector::Dist(*ViewLocation, DebrisRecord.Component->GetComponentLocation()) * 0.01f;
+	}
+
+	// off-screen debris always goes first
+	if (!DebrisRecord.Component->WasRecentlyRendered(0.1f))
+	{
+		score += 100000.0f;
+	}
+
+	return score;
+}
+
+void UDebrisSubsystem::SettleDebris(int32 RecordIndex, double Time)
+{
+	FDebrisRecord& debrisRecord = DebrisRecords[RecordIndex];
+
+	UDebrisStaticMeshComponent* debrisComponent = debrisRecord.Component;
+	UStaticMesh* staticMesh = debrisComponent->GetStaticMesh();
+
+	if (staticMesh)
+	{
+		FSettledDebrisBatch& settledDebrisBatch = GetSettledDebrisBatch(staticMesh);
+
+		const FTransform instanceTransform = debrisComponent->GetComponentTransform();
+		const double despawnStartTime = Time + debrisRecord.Lifetime;
+		const double despawnEndTime = despawnStartTime + debrisRecord.DespawnDuration;
+
+		int32 instanceIndex = INDEX_NONE;
+
+		if (settledDebrisBatch.FreeInstances.Num() > 0)
+		{
+			instanceIndex = settledDebrisBatch.FreeInstances.Pop();
+
+			settledDebrisBatch.Component->UpdateInstanceTransform(instanceIndex, instanceTransform, true, false, true);
+		}
+		else
+		{
+			instanceIndex = settledDebrisBatch.Component->AddInstance(instanceTransform, true);
+
+			settledDebrisBatch.InstanceEndTimes.SetNum(instanceIndex + 1);
+		}
+
+		settledDebrisBatch.Component->SetCustomDataValue(instanceIndex, 0, static_cast<float>(despawnStartTime), false);
+		settledDebrisBatch.Component->SetCustomDataValue(instanceIndex, 1, debrisRecord.DespawnDuration, true);
+
+		settledDebrisBatch.InstanceEndTimes[instanceIndex] = despawnEndTime;
+		settledDebrisBatch.NextEndTime = FMath::Min(settledDebrisBatch.NextEndTime, despawnEndTime);
+
+		++NumSettledDebris;
+	}
+
+	// the piece lives on as an instance, the component and its body go back to the pool
+	debrisComponent->BeginDespawn();
+
+	FinishDespawn(RecordIndex);
+}
+
+void UDebrisSubsystem::UpdateSettledDebris(double Time)
+{
+	const FTransform hiddenTransform(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector);
+
+	for (FSettledDebrisBatch& settledDebrisBatch : SettledDebrisBatches)
+	{
+		if (settledDebrisBatch.NextEndTime > Time || !IsValid(settledDebrisBatch.Component))
+		{
+			continue;
+		}
+
+		double nextEndTime = TNumericLimits<double>::Max();
+
+		for (int32 instanceIndex = 0; instanceIndex < settledDebrisBatch.InstanceEndTimes.Num(); ++instanceIndex)
+		{
+			double& instanceEndTime = settledDebrisBatch.InstanceEndTimes[instanceIndex];
+
+			if (instanceEndTime < 0.0)
+			{
+				continue;
+			}
+
+			if (instanceEndTime <= Time)
+			{
+				// instances are hidden instead of removed, removing would shift the indices of the other instances
+				settledDebrisBatch.Component->UpdateInstanceTransform(instanceIndex, hiddenTransform, true, false, true);
+				settledDebrisBatch.FreeInstances.Add(instanceIndex);
+
+				instanceEndTime = -1.0;
+
+				--NumSettledDebris;
+			}
+			else
+			{
+				nextEndTime = FMath::Min(nextEndTime, instanceEndTime);
+			}
+		}
+
+		settledDebrisBatch.NextEndTime = nextEndTime;
+		settledDebrisBatch.Component->MarkRenderStateDirty();
+	}
+}
+
+FSettledDebrisBatch& UDebrisSubsystem::GetSettledDebrisBatch(UStaticMesh* StaticMesh)
+{
+	if (const int32* batchIndex = SettledDebrisBatchIndices.Find(StaticMesh))
+	{
+		return SettledDebrisBatches[*batchIndex];
+	}
+
+	if (!SettledDebrisActor)
+	{
+		FActorSpawnParameters actorSpawnParameters;
+		actorSpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		actorSpawnParameters.ObjectFlags |= RF_Transient;
+
+		SettledDebrisActor = GetWorld()->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, actorSpawnParameters);
+
+		USceneComponent* rootComponent = NewObject<USceneComponent>(SettledDebrisActor);
+		SettledDebrisActor->SetRootComponent(rootComponent);
+		rootComponent->RegisterComponent();
+	}
+
+	UInstancedStaticMeshComponent* instancedComponent = NewObject<UInstancedStaticMeshComponent>(SettledDebrisActor);
+
+	instancedComponent->SetMobility(EComponentMobility::Movable);
+	instancedComponent->SetStaticMesh(StaticMesh);
+	instancedComponent->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	instancedComponent->SetCanEverAffectNavigation(false);
+	instancedComponent->NumCustomDataFloats = 2;
+	instancedComponent->SetupAttachment(SettledDebrisActor->GetRootComponent());
+	instancedComponent->RegisterComponent();
+
+	SettledDebrisActor->AddInstanceComponent(instancedComponent);
+
+	const int32 batchIndex = SettledDebrisBatches.AddDefaulted();
+
+	SettledDebrisBatches[batchIndex].Component = instancedComponent;
+	SettledDebrisBatchIndices.Add(StaticMesh, batchIndex);
+
+	return SettledDebrisBatches[batchIndex];
+}
+
+void UDebrisSubsystem::FinishDespawn(int32 RecordIndex)
+{
+	FDebrisRecord& debrisRecord = DebrisRecords[RecordIndex];
+
+	UDebrisStaticMeshComponent* debrisComponent = debrisRecord.Component;
+	ADebrisStaticMeshActor* debrisActor = debrisRecord.Actor;
+
+	if (IsSimulatingState(debrisRecord.State))
+	{
+		--NumSimulatingDebris;
+	}
+
+	// the generation survives the reset so timers scheduled for this record stay stale when it is reused
+	const uint32 nextGeneration = debrisRecord.Generation + 1;
+
+	debrisRecord = FDebrisRecord();
+	debrisRecord.Generation = nextGeneration;
+
+	FreeRecordIndices.Add(RecordIndex);
+
+	if (IsValid(debrisComponent))
+	{
+		debrisComponent->EndDespawn();
+		debrisComponent->SetDebrisRecordIndex(INDEX_NONE);
+	}
+
+	if (IsValid(debrisActor) && debrisActor->NotifyDebrisDespawned())
+	{
+		ReleaseDebris(debrisActor);
+	}
+}
+
+void UDebrisSubsystem::ReleaseDebris(ADebrisStaticMeshActor* DebrisActor)
+{
+	if (!IsValid(DebrisActor))
+	{
+		return;
+	}
+
+	if (FreeDebrisActors.Num() < CVarDebrisPoolMaxFreeActors.GetValueOnGameThread())
+	{
+		FreeDebrisActors.Add(DebrisActor);
+	}
+	else
+	{
+		NumDebrisBodies -= DebrisActor->GetNumDebris();
+
+		DebrisActor->Destroy();
+	}
+}
+
+ADebrisStaticMeshActor* UDebrisSubsystem::SpawnPooledActor()
+{
+	FActorSpawnParameters actorSpawnParameters;
+	actorSpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	actorSpawnParameters.ObjectFlags |= RF_Transient;
+
+	return GetWorld()->SpawnActor<ADebrisStaticMeshActor>(ADebrisStaticMeshActor::StaticClass(), FTransform::Identity, actorSpawnParameters);
+}
+
+ADebrisStaticMeshActor* UDebrisSubsystem::AcquireActor(const FDebrisSpawnParameters& SpawnParameters, int32 NumDebris)
+{
+	// pooled actors can be destroyed from the outside, e.g. by a level transition
+	FreeDebrisActors.RemoveAllSwap([](const TObjectPtr<ADebrisStaticMeshActor>& DebrisActor) { return !IsValid(DebrisActor); });
+
+	// an actor which was pre-warmed with the meshes of the spawn is activated without changing meshes,
+	// otherwise prefer the most recently released actor which has enough components to avoid creating new ones,
+	// actors reserved for the meshes of other fractures are taken last
+	int32 freeActorIndex = FreeDebrisActors.Num() - 1;
+	int32 prewarmedActorIndex = INDEX_NONE;
+	bool bHasEnoughDebris = false;
+
+	for (int32 actorIndex = FreeDebrisActors.Num() - 1; actorIndex >= 0; --actorIndex)
+	{
+		const ADebrisStaticMeshActor* freeActor = FreeDebrisActors[actorIndex];
+
+		if (freeActor->GetNumDebris() < NumDebris)
+		{
+			continue;
+		}
+
+		if (freeActor->HasDebrisMeshes(SpawnParameters))
+		{
+			freeActorIndex = actorIndex;
+			bHasEnoughDebris = true;
+			break;
+		}
+
+		if (IsPrewarmedActor(freeActor))
+		{
+			if (prewarmedActorIndex == INDEX_NONE)
+			{
+				prewarmedActorIndex = actorIndex;
+			}
+		}
+		else if (!bHasEnoughDebris)
+		{
+			freeActorIndex = actorIndex;
+			bHasEnoughDebris = true;
+		}
+	}
+
+	if (!bHasEnoughDebris && prewarmedActorIndex != INDEX_NONE)
+	{
+		freeActorIndex = prewarmedActorIndex;
+	}
+
+	if (freeActorIndex != INDEX_NONE)
+	{
+		ADebrisStaticMeshActor* debrisActor = FreeDebrisActors[freeActorIndex];
+
+		FreeDebrisActors.RemoveAtSwap(freeActorIndex);
+
+		// the activation may change the meshes of the actor
+		RemovePrewarmedActor(debrisActor);
+
+		return debrisActor;
+	}
+
+	UE_LOG(LogGravityDebris, Verbose, TEXT("Debris pool is empty, spawning a new debris actor."));
+
+	return SpawnPooledActor();
+}
\ No newline at end of file
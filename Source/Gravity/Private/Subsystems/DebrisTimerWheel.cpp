@@ -0,0 +1,56 @@
+#include "Subsystems/DebrisTimerWheel.h"
+
+FDebrisTimerWheel::FDebrisTimerWheel(double InSlotDuration, int32 InNumSlots)
+	: SlotDuration(InSlotDuration)
+	, CurrentTick(0)
+	, NumTimers(0)
+{
+	checkf(FMath::IsPowerOfTwo(InNumSlots), TEXT("The number of timer wheel slots must be a power of two."));
+	check(SlotDuration > 0.0);
+
+	Slots.SetNum(InNumSlots);
+}
+
+void FDebrisTimerWheel::Schedule(int32 RecordIndex, uint32 Generation, double DueTime)
+{
+	// timers which are due in the past go into the current slot, otherwise they would wait for a whole revolution
+	const int64 dueTick = FMath::Max(GetTick(DueTime), CurrentTick);
+
+	Slots[GetSlotIndex(dueTick)].Add({ RecordIndex, Generation, DueTime });
+
+	++NumTimers;
+}
+
+void FDebrisTimerWheel::Advance(double Time, TArray<FTimer>& OutDueTimers)
+{
+	if (NumTimers == 0)
+	{
+		CurrentTick = FMath::Max(GetTick(Time), CurrentTick);
+		return;
+	}
+
+	const int64 targetTick = FMath::Max(GetTick(Time), CurrentTick);
+
+	// the current slot is visited again because it can hold timers which were not due at the last advance,
+	// a slot can also hold timers of later revolutions which stay in the slot.
+	const int64 numVisitedSlots = FMath::Min<int64>(targetTick - CurrentTick + 1, Slots.Num());
+
+	for (int64 tick = targetTick - numVisitedSlots + 1; tick <= targetTick; ++tick)
+	{
+		TArray<FTimer>& slot = Slots[GetSlotIndex(tick)];
+
+		for (int32 timerIndex = slot.Num() - 1; timerIndex >= 0; --timerIndex)
+		{
+			if (slot[timerIndex].DueTime <= Time)
+			{
+				OutDueTimers.Add(slot[timerIndex]);
+
+				slot.RemoveAtSwap(timerIndex);
+
+				--NumTimers;
+			}
+		}
+	}
+
+	CurrentTick = targetTick;
+}
\ No newline at end of file
@@ -0,0 +1,420 @@
+#include "Subsystems/GravityFieldSubsystem.h"
+
+#include <Engine/World.h>
+#include <Components/PrimitiveComponent.h>
+#include <Chaos/SimCallbackObject.h>
+#include <Chaos/SimCallbackInput.h>
+#include <PBDRigidsSolver.h>
+#include <Physics/Experimental/PhysScene_Chaos.h>
+#include <PhysicsProxy/SingleParticlePhysicsProxy.h>
+
+DEFINE_LOG_CATEGORY(LogGravityField)
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Gravity Field Bodies"), STAT_GravityFieldBodies, STATGROUP_GravityField);
+DECLARE_CYCLE_STAT(TEXT("Gravity Field Pass"), STAT_GravityFieldPass, STATGROUP_GravityField);
+
+/**
+ * Body as seen by the physics thread.
+ */
+struct FGravityFieldSimBody
+{
+	/** Physics proxy of the body. */
+	FPhysicsActorHandle Proxy = nullptr;
+
+	/** Gravity acceleration of the body in cm/s^2, replaces the gravity of the regions if bHasGravity is set. */
+	FVector Gravity = FVector::ZeroVector;
+
+	/** True if the body has its own gravity. */
+	bool bHasGravity = false;
+};
+
+/**
+ * Snapshot of the bodies and regions sent from the game thread.
+ */
+struct FGravityFieldSimInput : public Chaos::FSimCallbackInput
+{
+	/** The registered bodies. */
+	TArray<FGravityFieldSimBody> Bodies;
+
+	/** The regions sorted by their priority, highest first. */
+	TArray<FGravityFieldRegion> Regions;
+
+	/** Gravity acceleration of the world in cm/s^2. */
+	FVector WorldGravity = FVector::ZeroVector;
+
+	/** True if the input holds a snapshot, the input of a frame without changes is empty. */
+	bool bHasSnapshot = false;
+
+	void Reset()
+	{
+		Bodies.Reset();
+		Regions.Reset();
+		bHasSnapshot = false;
+	}
+};
+
+/**
+ * Applies the gravity of the field to the registered bodies before each physics step.
+ * The snapshot of the last input is kept, so steps without a new input keep applying the same gravity.
+ */
+class FGravityFieldSimCallback : public Chaos::TSimCallbackObject<FGravityFieldSimInput>
+{
+private:
+	virtual void OnPreSimulate_Internal() override
+	{
+		SCOPE_CYCLE_COUNTER(STAT_GravityFieldPass);
+
+		if (const FGravityFieldSimInput* input = GetConsumerInput_Internal())
+		{
+			if (input->bHasSnapshot)
+			{
+				Bodies = input->Bodies;
+				Regions = input->Regions;
+				WorldGravity = input->WorldGravity;
+			}
+		}
+
+		for (const FGravityFieldSimBody& body : Bodies)
+		{
+			// the proxy of a body which was destroyed in this frame stays valid until the end of the step
+			if (!body.Proxy || body.Proxy->GetMarkedDeleted())
+			{
+				continue;
+			}
+
+			Chaos::FRigidBodyHandle_Internal* rigidBody = body.Proxy->GetPhysicsThreadAPI();
+
+			// sleeping bodies are woken by the game thread when their gravity changes
+			if (!rigidBody || rigidBody->ObjectState() != Chaos::EObjectStateType::Dynamic || !rigidBody->GravityEnabled())
+			{
+				continue;
+			}
+
+			FVector gravity = WorldGravity;
+
+			if (body.bHasGravity)
+			{
+				gravity = body.Gravity;
+			}
+			else
+			{
+				const FVector location = rigidBody->X();
+
+				for (const FGravityFieldRegion& region : Regions)
+				{
+					if (region.IsInside(location))
+					{
+						gravity = region.Gravity;
+						break;
+					}
+				}
+			}
+
+			// the engine gravity still acts on the body, only the difference is added
+			if (gravity != WorldGravity)
+			{
+				rigidBody->AddForce((gravity - WorldGravity) * rigidBody->M());
+			}
+		}
+	}
+
+private:
+	// Bodies of the last snapshot.
+	TArray<FGravityFieldSimBody> Bodies;
+
+	// Regions of the last snapshot, highest priority first.
+	TArray<FGravityFieldRegion> Regions;
+
+	// World gravity of the last snapshot.
+	FVector WorldGravity = FVector::ZeroVector;
+};
+
+bool UGravityFieldSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UGravityFieldSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	FPhysScene* physicsScene = InWorld.GetPhysicsScene();
+
+	if (!physicsScene || !physicsScene->GetSolver())
+	{
+		UE_LOG(LogGravityField, Warning, TEXT("World '%s' has no physics solver, the gravity field is disabled."), *InWorld.GetName());
+		return;
+	}
+
+	SimCallback = physicsScene->GetSolver()->CreateAndRegisterSimCallbackObject_External<FGravityFieldSimCallback>();
+
+	// the snapshot is sent right before the step, so proxies removed by the game thread in this frame leave it in the same step
+	PhysScenePreTickHandle = physicsScene->OnPhysScenePreTick.AddUObject(this, &UGravityFieldSubsystem::OnPhysScenePreTick);
+
+	// bodies and regions added before begin play reach the physics thread with the first step
+	bIsDirty = true;
+}
+
+void UGravityFieldSubsystem::Deinitialize()
+{
+	if (SimCallback)
+	{
+		FPhysScene* physicsScene = GetWorld()->GetPhysicsScene();
+
+		if (physicsScene)
+		{
+			physicsScene->OnPhysScenePreTick.Remove(PhysScenePreTickHandle);
+
+			if (physicsScene->GetSolver())
+			{
+				physicsScene->GetSolver()->UnregisterAndFreeSimCallbackObject_External(SimCallback);
+			}
+		}
+
+		PhysScenePreTickHandle.Reset();
+		SimCallback = nullptr;
+	}
+
+	for (const auto& body : Bodies)
+	{
+		if (UPrimitiveComponent* component = body.Value.Component.Get())
+		{
+			component->OnComponentPhysicsStateChanged.RemoveDynamic(this, &UGravityFieldSubsystem::OnBodyPhysicsStateChanged);
+		}
+	}
+
+	Bodies.Reset();
+	Regions.Reset();
+
+	Super::Deinitialize();
+}
+
+void UGravityFieldSubsystem::OnPhysScenePreTick(FPhysScene_Chaos* PhysicsScene, float DeltaTime)
+{
+	SET_DWORD_STAT(STAT_GravityFieldBodies, Bodies.Num());
+
+	// the world settings can change the world gravity at any time
+	if (SnapshotWorldGravity != GetWorldGravity())
+	{
+		bIsDirty = true;
+	}
+
+	if (bIsDirty && SimCallback)
+	{
+		PushSnapshot();
+
+		bIsDirty = false;
+	}
+}
+
+bool UGravityFieldSubsystem::RegisterBody(UPrimitiveComponent* Component)
+{
+	const FBodyInstance* bodyInstance = Component ? Component->GetBodyInstance() : nullptr;
+	const FPhysicsActorHandle proxy = bodyInstance ? bodyInstance->GetPhysicsActorHandle() : nullptr;
+
+	if (!proxy)
+	{
+		UE_LOG(LogGravityField, Warning, TEXT("Component '%s' has no body and can not be registered in the gravity field."), *GetNameSafe(Component));
+		return false;
+	}
+
+	FGravityFieldBody& body = Bodies.FindOrAdd(Component);
+
+	if (!body.Component.IsValid())
+	{
+		body.Component = Component;
+
+		// the body can be destroyed or recreated by streaming, SetStaticMesh or RecreatePhysicsState at any time
+		Component->OnComponentPhysicsStateChanged.AddUniqueDynamic(this, &UGravityFieldSubsystem::OnBodyPhysicsStateChanged);
+	}
+
+	if (body.Proxy != proxy)
+	{
+		body.Proxy = proxy;
+
+		bIsDirty = true;
+	}
+
+	return true;
+}
+
+void UGravityFieldSubsystem::UnregisterBody(UPrimitiveComponent* Component)
+{
+	if (Bodies.Remove(Component) > 0)
+	{
+		Component->OnComponentPhysicsStateChanged.RemoveDynamic(this, &UGravityFieldSubsystem::OnBodyPhysicsStateChanged);
+
+		bIsDirty = true;
+	}
+}
+
+void UGravityFieldSubsystem::OnBodyPhysicsStateChanged(UPrimitiveComponent* ChangedComponent, EComponentPhysicsStateChange StateChange)
+{
+	FGravityFieldBody* body = Bodies.Find(ChangedComponent);
+
+	if (!body)
+	{
+		return;
+	}
+
+	// a destroyed body leaves the next snapshot, the entry keeps the gravity of the body in case the body is recreated
+	if (StateChange == EComponentPhysicsStateChange::Destroyed)
+	{
+		body->Proxy = nullptr;
+	}
+	else
+	{
+		const FBodyInstance* bodyInstance = ChangedComponent->GetBodyInstance();
+
+		body->Proxy = bodyInstance ? bodyInstance->GetPhysicsActorHandle() : nullptr;
+	}
+
+	bIsDirty = true;
+}
+
+void UGravityFieldSubsystem::SetBodyGravity(UPrimitiveComponent* Component, const FVector& Gravity)
+{
+	if (!RegisterBody(Component))
+	{
+		return;
+	}
+
+	FGravityFieldBody& body = Bodies.FindChecked(Component);
+
+	if (!body.bHasGravity || body.Gravity != Gravity)
+	{
+		body.Gravity = Gravity;
+		body.bHasGravity = true;
+
+		Component->WakeRigidBody();
+
+		bIsDirty = true;
+	}
+}
+
+void UGravityFieldSubsystem::ClearBodyGravity(UPrimitiveComponent* Component)
+{
+	FGravityFieldBody* body = Bodies.Find(Component);
+
+	if (body && body->bHasGravity)
+	{
+		body->bHasGravity = false;
+
+		Component->WakeRigidBody();
+
+		bIsDirty = true;
+	}
+}
+
+int32 UGravityFieldSubsystem::AddRegion(const FGravityFieldRegion& Region)
+{
+	WakeBodiesInRegion(Region);
+
+	bIsDirty = true;
+
+	return Regions.Add(Region);
+}
+
+void UGravityFieldSubsystem::UpdateRegion(int32 RegionId, const FGravityFieldRegion& Region)
+{
+	if (!Regions.IsValidIndex(RegionId))
+	{
+		return;
+	}
+
+	WakeBodiesInRegion(Regions[RegionId]);
+	WakeBodiesInRegion(Region);
+
+	Regions[RegionId] = Region;
+
+	bIsDirty = true;
+}
+
+void UGravityFieldSubsystem::RemoveRegion(int32 RegionId)
+{
+	if (!Regions.IsValidIndex(RegionId))
+	{
+		return;
+	}
+
+	WakeBodiesInRegion(Regions[RegionId]);
+
+	Regions.RemoveAt(RegionId);
+
+	bIsDirty = true;
+}
+
+FVector UGravityFieldSubsystem::GetGravityAtLocation(const FVector& Location) const
+{
+	const FGravityFieldRegion* bestRegion = nullptr;
+
+	for (const FGravityFieldRegion& region : Regions)
+	{
+		if ((!bestRegion || region.Priority > bestRegion->Priority) && region.IsInside(Location))
+		{
+			bestRegion = &region;
+		}
+	}
+
+	return bestRegion ? bestRegion->Gravity : GetWorldGravity();
+}
+
+void UGravityFieldSubsystem::WakeBodiesInRegion(const FGravityFieldRegion& Region)
+{
+	for (const auto& body : Bodies)
+	{
+		UPrimitiveComponent* component = body.Value.Component.Get();
+
+		if (component && !body.Value.bHasGravity && component->IsSimulatingPhysics() && Region.IsInside(component->GetComponentLocation()))
+		{
+			component->WakeRigidBody();
+		}
+	}
+}
+
+void UGravityFieldSubsystem::PushSnapshot()
+{
+	FGravityFieldSimInput* input = SimCallback->GetProducerInputData_External();
+
+	input->Bodies.Reset(Bodies.Num());
+
+	for (auto it = Bodies.CreateIterator(); it; ++it)
+	{
+		// components which were destroyed without unregistering drop out here
+		if (!IsValid(it.Value().Component.Get()))
+		{
+			it.RemoveCurrent();
+			continue;
+		}
+
+		if (!it.Value().Proxy)
+		{
+			continue;
+		}
+
+		FGravityFieldSimBody& simBody = input->Bodies.AddDefaulted_GetRef();
+		simBody.Proxy = it.Value().Proxy;
+		simBody.Gravity = it.Value().Gravity;
+		simBody.bHasGravity = it.Value().bHasGravity;
+	}
+
+	input->Regions.Reset(Regions.Num());
+
+	for (const FGravityFieldRegion& region : Regions)
+	{
+		input->Regions.Add(region);
+	}
+
+	// the physics thread takes the first region which contains a body
+	input->Regions.StableSort([](const FGravityFieldRegion& A, const FGravityFieldRegion& B) { return A.Priority > B.Priority; });
+
+	SnapshotWorldGravity = GetWorldGravity();
+
+	input->WorldGravity = SnapshotWorldGravity;
+	input->bHasSnapshot = true;
+}
+
+FVector UGravityFieldSubsystem::GetWorldGravity() const
+{
+	return FVector(0.0, 0.0, GetWorld()->GetGravityZ());
+}
\ No newline at end of file
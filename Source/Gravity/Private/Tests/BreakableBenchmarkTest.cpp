@@ -0,0 +1,151 @@
+#include <CoreMinimal.h>
+#include <Misc/AutomationTest.h>
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include <Engine/Engine.h>
+#include <Engine/World.h>
+#include <HAL/IConsoleManager.h>
+#include <Tests/AutomationCommon.h>
+
+#include "Subsystems/BreakableSubsystem.h"
+
+static TAutoConsoleVariable<int32> CVarBreakableBenchmarkTestBreaks(
+	TEXT("gravity.Breakable.BenchmarkTest.NumBreaks"),
+	200,
+	TEXT("Number of items the breakable benchmark test breaks."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarBreakableBenchmarkTestBreaksPerFrame(
+	TEXT("gravity.Breakable.BenchmarkTest.BreaksPerFrame"),
+	4,
+	TEXT("Number of items the breakable benchmark test breaks per frame."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBreakableBenchmarkTestBudgetP95(
+	TEXT("gravity.Breakable.BenchmarkTest.BudgetP95Ms"),
+	16.6f,
+	TEXT("The breakable benchmark test fails if the p95 game thread time in ms exceeds this budget."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBreakableBenchmarkTestBudgetP99(
+	TEXT("gravity.Breakable.BenchmarkTest.BudgetP99Ms"),
+	33.3f,
+	TEXT("The breakable benchmark test fails if the p99 game thread time in ms exceeds this budget."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBreakableBenchmarkTestTimeout(
+	TEXT("gravity.Breakable.BenchmarkTest.Timeout"),
+	300.0f,
+	TEXT("Seconds after which the breakable benchmark test gives up."),
+	ECVF_Default);
+
+static const TCHAR* BreakableBenchmarkTestMap = TEXT("/Game/GR2/Levels/Test/TestArea3/TestArea3");
+
+static UBreakableSubsystem* GetBenchmarkBreakableSubsystem()
+{
+	for (const FWorldContext& worldContext : GEngine->GetWorldContexts())
+	{
+		UWorld* world = worldContext.World();
+
+		if (world && (worldContext.WorldType == EWorldType::Game || worldContext.WorldType == EWorldType::PIE))
+		{
+			return world->GetSubsystem<UBreakableSubsystem>();
+		}
+	}
+
+	return nullptr;
+}
+
+DEFINE_LATENT_AUTOMATION_COMMAND_ONE_PARAMETER(FStartBreakableBenchmarkCommand, FAutomationTestBase*, Test);
+
+bool FStartBreakableBenchmarkCommand::Update()
+{
+	UBreakableSubsystem* breakableSubsystem = GetBenchmarkBreakableSubsystem();
+
+	if (!breakableSubsystem)
+	{
+		Test->AddError(FString::Printf(TEXT("The map '%s' has no breakable subsystem."), BreakableBenchmarkTestMap));
+		return true;
+	}
+
+	breakableSubsystem->StartBenchmark(CVarBreakableBenchmarkTestBreaks.GetValueOnGameThread(), CVarBreakableBenchmarkTestBreaksPerFrame.GetValueOnGameThread());
+
+	if (!breakableSubsystem->IsBenchmarkRunning())
+	{
+		Test->AddError(FString::Printf(TEXT("The breakable benchmark did not start on '%s'."), BreakableBenchmarkTestMap));
+	}
+
+	return true;
+}
+
+DEFINE_LATENT_AUTOMATION_COMMAND_ONE_PARAMETER(FWaitForBreakableBenchmarkCommand, FAutomationTestBase*, Test);
+
+bool FWaitForBreakableBenchmarkCommand::Update()
+{
+	const UBreakableSubsystem* breakableSubsystem = GetBenchmarkBreakableSubsystem();
+
+	if (!breakableSubsystem)
+	{
+		return true;
+	}
+
+	if (breakableSubsystem->IsBenchmarkRunning())
+	{
+		if (GetCurrentRunTime() > CVarBreakableBenchmarkTestTimeout.GetValueOnGameThread())
+		{
+			Test->AddError(TEXT("The breakable benchmark did not finish in time."));
+			return true;
+		}
+
+		return false;
+	}
+
+	const FBreakableBenchmarkResult& benchmarkResult = breakableSubsystem->GetBenchmarkResult();
+
+	if (benchmarkResult.GameThreadTimes.Num() == 0)
+	{
+		Test->AddError(TEXT("The breakable benchmark recorded no frames."));
+		return true;
+	}
+
+	// the game thread time is compared, the frame time is bound to the frame rate limit under -nullrhi
+	const float gameThreadTimeP95 = benchmarkResult.GetGameThreadTime(95);
+	const float gameThreadTimeP99 = benchmarkResult.GetGameThreadTime(99);
+	const float budgetP95 = CVarBreakableBenchmarkTestBudgetP95.GetValueOnGameThread();
+	const float budgetP99 = CVarBreakableBenchmarkTestBudgetP99.GetValueOnGameThread();
+
+	Test->AddInfo(FString::Printf(TEXT("Game thread p95 %.3f ms (budget %.3f ms), p99 %.3f ms (budget %.3f ms) over %d frames."),
+		gameThreadTimeP95, budgetP95, gameThreadTimeP99, budgetP99, benchmarkResult.GameThreadTimes.Num()));
+
+	if (gameThreadTimeP95 > budgetP95)
+	{
+		Test->AddError(FString::Printf(TEXT("The p95 game thread time %.3f ms exceeds the budget of %.3f ms."), gameThreadTimeP95, budgetP95));
+	}
+
+	if (gameThreadTimeP99 > budgetP99)
+	{
+		Test->AddError(FString::Printf(TEXT("The p99 game thread time %.3f ms exceeds the budget of %.3f ms."), gameThreadTimeP99, budgetP99));
+	}
+
+	return true;
+}
+
+/**
+ * Breaks the breakables of TestArea3 and fails if the p95 or p99 game thread time exceeds its budget.
+ * Meant as a regression gate, e.g. -nullrhi -ExecCmds="Automation RunTests Gravity.Breakables.Benchmark; Quit".
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBreakableBenchmarkTest, "Gravity.Breakables.Benchmark",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::PerfFilter)
+
+bool FBreakableBenchmarkTest::RunTest(const FString& Parameters)
+{
+	AutomationOpenMap(BreakableBenchmarkTestMap);
+
+	ADD_LATENT_AUTOMATION_COMMAND(FStartBreakableBenchmarkCommand(this));
+	ADD_LATENT_AUTOMATION_COMMAND(FWaitForBreakableBenchmarkCommand(this));
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
\ No newline at end of file
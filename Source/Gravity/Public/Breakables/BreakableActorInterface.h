@@ -8,6 +8,26 @@ DECLARE_LOG_CATEGORY_EXTERN(LogGravityBreakableObject, Display, All)
 
 class UStaticMesh;
 class UPhysicalMaterial;
+class UBreakableFractureData;
+
+/**
+ * Level of detail of the debris of a break.
+ */
+UENUM(BlueprintType)
+enum class EBreakableDebrisLOD : uint8
+{
+	/** All debris pieces are spawned. */
+	Full,
+
+	/** Only the heaviest pieces are spawned. */
+	Reduced,
+
+	/** All pieces are spawned as cosmetic debris which only collides with the static world. */
+	Cosmetic,
+
+	/** No debris is spawned, only the broken mesh remains. */
+	None
+};
 
 USTRUCT()
 struct FActorBreakResult
@@ -19,6 +39,54 @@ struct FActorBreakResult
 
 	/** Transform for swapning of debris. */
 	FTransform DebrisTransform = FTransform::Identity;
+
+	/** Linear velocity of the broken object which is passed on to the debris. */
+	FVector DebrisLinearVelocity = FVector::ZeroVector;
+
+	/** Item index of the broken instance, INDEX_NONE for breakables without instances. */
+	int32 BrokenItem = INDEX_NONE;
+};
+
+/**
+ * Baked support between two breakable items, the target breaks when the source breaks.
+ */
+USTRUCT()
+struct FBreakableSupportLink
+{
+	GENERATED_BODY()
+
+	/** Item of this breakable which supports the target, INDEX_NONE for breakables without instances. */
+	UPROPERTY(VisibleAnywhere, Category="Breakable")
+	int32 SourceItem = INDEX_NONE;
+
+	/** The supported breakable, can be the breakable itself. */
+	UPROPERTY(VisibleAnywhere, Category="Breakable")
+	TSoftObjectPtr<ABreakableActorInterface> Target;
+
+	/** The supported item of the target, INDEX_NONE for breakables without instances. */
+	UPROPERTY(VisibleAnywhere, Category="Breakable")
+	int32 TargetItem = INDEX_NONE;
+};
+
+/**
+ * A part of a breakable which breaks on its own, e.g. an instance, it is registered in the spatial index of the UBreakableSubsystem.
+ */
+struct FBreakableItem
+{
+	/** Component which receives the hits of the item. */
+	UPrimitiveComponent* Component = nullptr;
+
+	/** Item index of the instance, INDEX_NONE for breakables without instances. */
+	int32 Item = INDEX_NONE;
+
+	/** Bounding sphere of the item in world space. */
+	FSphere Bounds = FSphere(ForceInit);
+
+	/** Bounding box of the item in world space. */
+	FBox Box = FBox(ForceInit);
+
+	/** True if the item can move, its bounds are read from the component on each query. */
+	bool bIsMovable = false;
 };
 
 UCLASS(ClassGroup=Breakable, Abstract, Blueprintable, MinimalAPI)
@@ -29,6 +97,15 @@ class ABreakableActorInterface : public AActor
 public:
 	ABreakableActorInterface();
 
+#if WITH_EDITOR
+	/**
+	 * Links the items of this breakable to the items of the breakables resting on them, including its own items.
+	 * An item is supported if its bounding box overlaps the box of an item in XY and its bottom is within SupportTolerance of the top of that item.
+	 */
+	UFUNCTION(CallInEditor, Category="Breakable")
+	void BakeSupportLinks();
+#endif
+
 	void NotifyHit(UPrimitiveComponent* MyComp, AActor* Other, UPrimitiveComponent* OtherComp, bool bSelfMoved, FVector HitLocation, FVector HitNormal, FVector NormalImpulse, const FHitResult& Hit) override;
 
 	/**
@@ -43,22 +120,99 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Breakable")
 	bool IsBreakable() const { return bIsBreakable; }
 
-#if WITH_EDITOR
-	virtual void PostEditChangeChainProperty(FPropertyChangedChainEvent& PropertyChangedEvent) override;
-#endif
+	/**
+	 * @returns Accumulated contact impulse in kg*cm/s which breaks the actor.
+	 */
+	float GetBreakThreshold() const { return BreakThreshold; }
+
+	/**
+	 * Evaluates a hit and spawns the debris if the actor broke. Called by the UBreakableSubsystem in its batched pass.
+	 * @param MyComponent The hit component of the actor.
+	 * @param OtherComponent The component which hit the actor, can be null.
+	 * @param NormalImpulse Contact impulse of the hit in kg*cm/s.
+	 * @param Hit The hit result.
+	 * @returns True if the actor or the hit instance broke.
+	 */
+	bool ProcessHit(UPrimitiveComponent* MyComponent, UPrimitiveComponent* OtherComponent, const FVector& NormalImpulse, const FHitResult& Hit);
+
+	/**
+	 * Breaks an item like a hit which is strong enough would do.
+	 * @param Item Item index of the instance, INDEX_NONE for breakables without instances.
+	 * @returns True if the item broke.
+	 */
+	virtual bool BreakItem(int32 Item) { return false; }
+
+	/**
+	 * Collects the unbroken items of the actor for the spatial index.
+	 * @param OutItems Receives the items.
+	 */
+	virtual void GetBreakableItems(TArray<FBreakableItem>& OutItems) const {}
+
+	/**
+	 * Collects the broken state of the actor which is restored when the actor streams in again.
+	 * @param OutBrokenItems Receives one bit per item, set for broken items.
+	 * @returns True if any item is broken.
+	 */
+	virtual bool GetBrokenState(TBitArray<>& OutBrokenItems) const { return false; }
+
+	/**
+	 * Restores the broken state of the actor with one bulk update, called on begin play before the actor registers with the subsystems.
+	 * @param BrokenItems One bit per item, set for broken items.
+	 */
+	virtual void ApplyBrokenState(const TBitArray<>& BrokenItems) {}
+
+	/**
+	 * Applies the render and physics state changes of the breaks since the last flush. Called once per frame by the UBreakableSubsystem
+	 * for actors which requested a flush.
+	 */
+	virtual void OnFlushBreaks() {}
+
+	/**
+	 * @returns Debris pieces which are spawned when the actor breaks.
+	 */
+	UBreakableFractureData* GetFractureData() const { return FractureData; }
 
 protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	/**
-	 * Event that is triggered when the actor is broken.
+	 * Event that is triggered when the actor is hit hard enough to take damage.
+	 * @param MyComponent The hit component of the actor.
+	 * @param OtherComponent The component which hit the actor.
+	 * @param NormalImpulse Contact impulse of the hit in kg*cm/s.
+	 * @param Hit The hit result.
 	 * @returns Result of the actor breaking apart.
 	 */
-	virtual FActorBreakResult OnBreakActor(UPrimitiveComponent* MyComponent, UPrimitiveComponent* OtherComponent, const FHitResult& Hit) PURE_VIRTUAL(ABreakableActorInterface::OnBreakActor, return {}; );
+	virtual FActorBreakResult OnBreakActor(UPrimitiveComponent* MyComponent, UPrimitiveComponent* OtherComponent, const FVector& NormalImpulse, const FHitResult& Hit) PURE_VIRTUAL(ABreakableActorInterface::OnBreakActor, return {}; );
+
+	/**
+	 * Adds the damage of a hit to the accumulated damage of the actor or one of its instances.
+	 * @param InOutDamage The accumulated damage which receives the damage of the hit.
+	 * @param NormalImpulse Contact impulse of the hit in kg*cm/s.
+	 * @returns True if the accumulated damage reached the break threshold.
+	 */
+	bool ApplyImpulseDamage(float& InOutDamage, const FVector& NormalImpulse) const;
 
 	/**
-	 * Spawns debris for an instance.
+	 * Spawns debris for an instance from the debris pool.
 	 * @param RelativeTransform Transform of the debris spawn point.
+	 * @param LinearVelocity Initial velocity of the debris.
+	 */
+	virtual void OnSpawnDebris(const FTransform& RelativeTransform, const FVector& LinearVelocity);
+
+	/**
+	 * Chooses the debris level of detail from the distance between a location and the player's view.
+	 * @param Location World location of the debris.
+	 * @returns The debris level of detail, Full if there is no player.
 	 */
-	virtual void OnSpawnDebris(const FTransform& RelativeTransform);
+	EBreakableDebrisLOD GetDebrisLOD(const FVector& Location) const;
+
+	/**
+	 * Queues the breaks of the items which are supported by a broken item.
+	 * @param Item The broken item.
+	 */
+	void QueueSupportedBreaks(int32 Item);
 
 	/**
 	 * Peforms post-break work like spawning debris.
@@ -79,19 +233,17 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Breakable")
 	TObjectPtr<UStaticMesh> BrokenStaticMesh;
 
-#if WITH_EDITORONLY_DATA
 	/**
-	 * Path to the directory containing debris static meshes.
-     */
-	UPROPERTY(EditAnywhere, Category="Breakable", meta = (ContentDir))
-	FDirectoryPath DebrisStaticMeshDir;
-#endif
+	 * Accumulated contact impulse in kg*cm/s which breaks the object. A single hit with this impulse breaks the object right away.
+	 */
+	UPROPERTY(EditAnywhere, Category="Breakable", meta = (ClampMin = "0.0"))
+	float BreakThreshold;
 
 	/**
-	 * Threshold for the break event.
+	 * Hits with a contact impulse in kg*cm/s below this threshold do not damage the object, e.g. resting or sliding contacts.
 	 */
-	UPROPERTY(EditAnywhere, Category="Breakable")
-	float BreakThreshold;
+	UPROPERTY(EditAnywhere, Category="Breakable", meta = (ClampMin = "0.0"))
+	float DamageThreshold;
 
 	/**
 	 * Set to true if you want the object to never break.
@@ -100,10 +252,10 @@ protected:
 	bool bIsBreakable;
 
 	/**
-	 * Collection of static meshes for rendering debris.
+	 * Debris pieces of the broken object, shared by all breakables with the same fracture.
 	 */
 	UPROPERTY(EditAnywhere, Category="Breakable")
-	TArray<TObjectPtr<UStaticMesh>> DebrisStaticMeshes;
+	TObjectPtr<UBreakableFractureData> FractureData;
 
 	/**
 	 * Physical material for the debris.
@@ -122,4 +274,46 @@ protected:
 	 */
 	UPROPERTY(EditAnywhere, Category="Breakable")
 	float DebrisDespawnDuration;
+
+	/**
+	 * Distance to the player's view from which only the heaviest pieces are spawned, scaled by gravity.Debris.LODDistanceScale.
+	 */
+	UPROPERTY(EditAnywhere, Category="Breakable|Debris LOD", meta = (ClampMin = "0.0", Units = "Centimeters"))
+	float DebrisReducedDistance;
+
+	/**
+	 * Distance to the player's view from which the debris is cosmetic, scaled by gravity.Debris.LODDistanceScale.
+	 */
+	UPROPERTY(EditAnywhere, Category="Breakable|Debris LOD", meta = (ClampMin = "0.0", Units = "Centimeters"))
+	float DebrisCosmeticDistance;
+
+	/**
+	 * Distance to the player's view from which no debris is spawned, scaled by gravity.Debris.LODDistanceScale.
+	 */
+	UPROPERTY(EditAnywhere, Category="Breakable|Debris LOD", meta = (ClampMin = "0.0", Units = "Centimeters"))
+	float DebrisCullDistance;
+
+	/**
+	 * Fraction of the pieces which is spawned with reduced debris.
+	 */
+	UPROPERTY(EditAnywhere, Category="Breakable|Debris LOD", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+	float DebrisReducedFraction;
+
+	/**
+	 * Breaks the supported items when an item of this breakable breaks, the breaks spread under a per-frame budget.
+	 */
+	UPROPERTY(EditAnywhere, Category="Breakable|Support")
+	bool bPropagateBreaks;
+
+	/**
+	 * Gap in cm up to which two items count as touching when the support links are baked.
+	 */
+	UPROPERTY(EditAnywhere, Category="Breakable|Support", meta = (ClampMin = "0.0", Units = "Centimeters"))
+	float SupportTolerance;
+
+	/**
+	 * Baked support links sorted by their source item.
+	 */
+	UPROPERTY(VisibleAnywhere, Category="Breakable|Support")
+	TArray<FBreakableSupportLink> SupportLinks;
 };
\ No newline at end of file
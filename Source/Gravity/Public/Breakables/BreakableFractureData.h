@@ -0,0 +1,155 @@
+#pragma once
+
+#include <Engine/DataAsset.h>
+
+#include "BreakableFractureData.generated.h"
+
+class UStaticMesh;
+class UBodySetup;
+
+/**
+ * Simple collision shape which is baked for the debris pieces.
+ */
+UENUM(BlueprintType)
+enum class EBreakableCollisionShape : uint8
+{
+	/** Convex hull of the lowest LOD of the piece mesh, simplified to at most MaxConvexVertices vertices. */
+	Convex,
+
+	/** Box fitted to the bounds of the piece mesh. */
+	Box,
+
+	/** Sphere fitted to the bounds of the piece mesh. */
+	Sphere
+};
+
+USTRUCT(BlueprintType)
+struct FBreakableFracturePiece
+{
+	GENERATED_BODY()
+
+	/** Mesh of the debris piece. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Fracture")
+	TSoftObjectPtr<UStaticMesh> StaticMesh;
+
+	/** Transform of the piece relative to the transform of the broken object. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Fracture")
+	FTransform RelativeTransform = FTransform::Identity;
+
+	/** Mass of the piece in kg. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Fracture")
+	float Mass = 0.0f;
+
+	/** Diagonal of the inertia tensor of the piece in kg*cm^2, approximated by the bounding box. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Fracture")
+	FVector InertiaTensor = FVector::ZeroVector;
+
+	/** Bounds of the piece in its local space. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Fracture")
+	FBox Bounds = FBox(ForceInit);
+
+	/** Baked simple collision of the piece, the debris simulates against it instead of the collision of the mesh. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Fracture")
+	TObjectPtr<UBodySetup> BodySetup;
+};
+
+/**
+ * Debris pieces of a fractured object. The data is baked from a directory of debris meshes and shared by all breakables using the fracture.
+ * The piece meshes are soft references, they are streamed in by the debris subsystem while a breakable using the fracture is close to the player.
+ * The bake fits a simple collision shape to every piece, imported meshes often collide with their render mesh which is expensive to simulate.
+ */
+UCLASS(ClassGroup=Breakable, BlueprintType, MinimalAPI)
+class UBreakableFractureData : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UBreakableFractureData();
+
+#if WITH_EDITOR
+	/**
+	 * Rebuilds the pieces from the meshes in SourceMeshDir. Relative transforms of pieces that already exist are kept.
+	 */
+	UFUNCTION(CallInEditor, Category="Fracture")
+	void Bake();
+#endif
+
+	/**
+	 * Loads the meshes of all pieces synchronously and keeps them resident.
+	 */
+	void LoadStaticMeshes();
+
+	/**
+	 * Collects the paths of the piece meshes for asynchronous loading.
+	 * @param OutPaths Receives the mesh paths.
+	 */
+	void GetStaticMeshPaths(TArray<FSoftObjectPath>& OutPaths) const;
+
+	/**
+	 * Keeps the piece meshes which are loaded resident.
+	 */
+	void ResolveStaticMeshes();
+
+	/**
+	 * Drops the references to the piece meshes so they can be unloaded.
+	 */
+	void ReleaseStaticMeshes();
+
+	/**
+	 * @returns True if the piece meshes are resident and debris can be spawned.
+	 */
+	bool AreStaticMeshesLoaded() const { return Pieces.Num() > 0 && LoadedStaticMeshes.Num() == Pieces.Num(); }
+
+	/**
+	 * @returns The loaded piece meshes in the order of the pieces, entries are null if the mesh is not loaded.
+	 */
+	const TArray<TObjectPtr<UStaticMesh>>& GetLoadedStaticMeshes() const { return LoadedStaticMeshes; }
+
+	/**
+	 * @returns The debris pieces.
+	 */
+	const TArray<FBreakableFracturePiece>& GetPieces() const { return Pieces; }
+
+protected:
+#if WITH_EDITORONLY_DATA
+	/**
+	 * Path to the directory containing the debris meshes to bake.
+	 */
+	UPROPERTY(EditAnywhere, Category="Fracture", meta = (ContentDir))
+	FDirectoryPath SourceMeshDir;
+#endif
+
+	/**
+	 * Density in g/cm^3 which is used to bake the mass of the pieces.
+	 */
+	UPROPERTY(EditAnywhere, Category="Fracture", meta = (ClampMin = "0.001"))
+	float Density;
+
+	/**
+	 * Simple collision shape which is baked for the pieces.
+	 */
+	UPROPERTY(EditAnywhere, Category="Fracture")
+	EBreakableCollisionShape CollisionShape;
+
+	/**
+	 * Maximum number of vertices of the baked convex hulls, fewer vertices make the debris cheaper to simulate.
+	 */
+	UPROPERTY(EditAnywhere, Category="Fracture", meta = (ClampMin = "4", EditCondition = "CollisionShape == EBreakableCollisionShape::Convex"))
+	int32 MaxConvexVertices;
+
+	/**
+	 * The baked debris pieces.
+	 */
+	UPROPERTY(EditAnywhere, Category="Fracture")
+	TArray<FBreakableFracturePiece> Pieces;
+
+private:
+#if WITH_EDITOR
+	// Fits the simple collision of a piece to its mesh, the body setup of the previous bake is reused if there is one.
+	UBodySetup* BakeBodySetup(const UStaticMesh* StaticMesh, UBodySetup* PreviousBodySetup);
+#endif
+
+	// Hard references to the loaded piece meshes.
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UStaticMesh>> LoadedStaticMeshes;
+};
\ No newline at end of file
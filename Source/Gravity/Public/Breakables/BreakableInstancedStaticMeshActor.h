@@ -28,18 +28,28 @@ public:
 	bool BreakInstance(int32 InstanceIndex, bool bForce = false);
 
 	/**
-	 * Allows you to check if an instance is broken.
-	 * @param InstanceIndex The 
+	 * Allows you to check if an instance is broken. Broken instances keep their index, they are hidden with a zero scale.
+	 * @param InstanceIndex The index of the instance.
 	 * @returns True if an instance is broken.
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Breakable")
 	bool IsInstanceBroken(int32 InstanceIndex) const;
 
 private:
-	FActorBreakResult OnBreakActor(UPrimitiveComponent* MyComponent, UPrimitiveComponent* OtherComponent, const FHitResult& Hit) override;
+	FActorBreakResult OnBreakActor(UPrimitiveComponent* MyComponent, UPrimitiveComponent* OtherComponent, const FVector& NormalImpulse, const FHitResult& Hit) override;
 
 	FActorBreakResult BreakInstanceInternal(int32 InstanceIndex, bool bForce);
 
+	void OnFlushBreaks() override;
+
+	void GetBreakableItems(TArray<FBreakableItem>& OutItems) const override;
+
+	bool BreakItem(int32 Item) override;
+
+	bool GetBrokenState(TBitArray<>& OutBrokenItems) const override;
+
+	void ApplyBrokenState(const TBitArray<>& BrokenItems) override;
+
 private:
 	/**
 	 * The ISM component for rendering the intact object and receive hit events.
@@ -53,6 +63,18 @@ private:
 	UPROPERTY()
 	TObjectPtr<UInstancedStaticMeshComponent> BrokenISMComponent;
 
+	// Accumulated contact impulse of the hits in kg*cm/s per base instance, sized on the first damaging hit.
+	TArray<float> InstanceDamage;
+
+	// Broken state per base instance, sized on the first break.
+	TBitArray<> BrokenInstances;
+
+	// Number of set bits in BrokenInstances.
+	int32 NumBrokenInstances;
+
+	// Broken instances whose transforms are updated in the next flush.
+	TArray<int32> PendingBrokenInstances;
+
 #if WITH_EDITORONLY_DATA
 	/**
 	 * Relative transforms of the instances.
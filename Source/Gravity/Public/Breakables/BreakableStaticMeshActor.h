@@ -33,10 +33,21 @@ public:
 	bool IsActorBroken() const { return bIsActorBroken; }
 
 private:
-	FActorBreakResult OnBreakActor(UPrimitiveComponent* MyComponent, UPrimitiveComponent* OtherComponent, const FHitResult& Hit) override;
+	FActorBreakResult OnBreakActor(UPrimitiveComponent* MyComponent, UPrimitiveComponent* OtherComponent, const FVector& NormalImpulse, const FHitResult& Hit) override;
 
 	FActorBreakResult BreakActorInternal(bool bForce);
 
+	void GetBreakableItems(TArray<FBreakableItem>& OutItems) const override;
+
+	bool BreakItem(int32 Item) override;
+
+	bool GetBrokenState(TBitArray<>& OutBrokenItems) const override;
+
+	void ApplyBrokenState(const TBitArray<>& BrokenItems) override;
+
+	// Swaps in the broken mesh or destroys the actor if there is none.
+	void SetBrokenMesh();
+
 private:
 	/**
 	 * The static mesh component for rendering the object and receive hit events.
@@ -49,4 +60,7 @@ private:
 	 */
 	UPROPERTY()
 	bool bIsActorBroken;
+
+	// Accumulated contact impulse of the hits in kg*cm/s.
+	float Damage;
 };
\ No newline at end of file
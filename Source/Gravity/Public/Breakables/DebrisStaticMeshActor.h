@@ -4,7 +4,10 @@
 
 #include "DebrisStaticMeshActor.generated.h"
 
+class UStaticMesh;
 class UDebrisStaticMeshComponent;
+class UBreakableFractureData;
+struct FDebrisSpawnParameters;
 
 UCLASS(ClassGroup=Breakable, Blueprintable, MinimalAPI)
 class ADebrisStaticMeshActor : public AActor
@@ -14,14 +17,54 @@ class ADebrisStaticMeshActor : public AActor
 public:
 	ADebrisStaticMeshActor();
 
-	virtual void TickActor(float DeltaTime, ELevelTick TickType, FActorTickFunction& ThisTickFunction) override;
-
 	/**
-	 * Creates a debris object with default parameters.
+	 * Creates an inactive debris object with default parameters.
 	 */
 	UDebrisStaticMeshComponent* AddDebris();
 
+	/**
+	 * Gives the inactive debris objects the meshes and simple collision of the pieces of a fracture, so their physics bodies exist before the actor is activated.
+	 * Objects which already have the mesh of a piece keep it, the other objects change their mesh and new objects are only created if needed.
+	 * @param FractureData The fracture data, pieces whose mesh is not loaded are skipped.
+	 */
+	void PrewarmDebris(const UBreakableFractureData& FractureData);
+
+	/**
+	 * @returns True if the debris objects have the meshes of all loaded pieces of the fracture, one object per piece.
+	 */
+	bool HasDebrisMeshes(const UBreakableFractureData& FractureData) const;
+
+	/**
+	 * @returns True if the debris objects have the meshes of all pieces of the spawn, one object per piece.
+	 */
+	bool HasDebrisMeshes(const FDebrisSpawnParameters& SpawnParameters) const;
+
+	/**
+	 * Activates one debris object per piece, existing objects are reused and new ones are only created if needed.
+	 * @param SpawnParameters Meshes, transform and velocity of the debris.
+	 * @param OutActivatedDebris Receives the activated debris objects.
+	 */
+	void ActivateDebris(const FDebrisSpawnParameters& SpawnParameters, TArray<UDebrisStaticMeshComponent*>& OutActivatedDebris);
+
+	/**
+	 * Must be called once for every activated debris object when it finished despawning.
+	 * @returns True if all debris objects of the actor despawned.
+	 */
+	bool NotifyDebrisDespawned();
+
+	/**
+	 * @returns Number of debris objects owned by this actor.
+	 */
+	int32 GetNumDebris() const { return DebrisStaticMeshComponents.Num(); }
+
+private:
+	// Matches each mesh to a different debris object, null meshes are skipped.
+	bool HasDebrisMeshes(TConstArrayView<const UStaticMesh*> StaticMeshes) const;
+
 private:
 	UPROPERTY()
 	TArray<TObjectPtr<UDebrisStaticMeshComponent>> DebrisStaticMeshComponents;
+
+	// Number of activated debris objects that did not finish despawning yet.
+	int32 NumAliveDebris;
 };
\ No newline at end of file
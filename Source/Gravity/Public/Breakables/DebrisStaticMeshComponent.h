@@ -4,6 +4,14 @@
 
 #include "DebrisStaticMeshComponent.generated.h"
 
+struct FDebrisSpawnParameters;
+struct FDebrisPieceParameters;
+
+/**
+ * A single debris piece. The component does not tick, its despawn state machine is driven by the UDebrisSubsystem
+ * from the sleep and wake events of its body. The despawn fade runs in the material from the custom primitive data.
+ * Simulating debris is registered in the gravity field, so it follows gravity regions like any other lifted or thrown body.
+ */
 UCLASS(ClassGroup=Breakable, Blueprintable, MinimalAPI)
 class UDebrisStaticMeshComponent : public UStaticMeshComponent
 {
@@ -12,47 +20,65 @@ class UDebrisStaticMeshComponent : public UStaticMeshComponent
 public:
 	UDebrisStaticMeshComponent();
 
-	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
-
-	bool IsDebrisAlife() const { return bIsDebrisAlife; }
-
-	void SetDebrisLifetime(float InLifetime) { DebrisLifetime = InLifetime; }
-	void SetDebrisDespawnDuration(float InTimeout) { DebrisDespawnDuration = InTimeout; }
-
-	float GetDebrisLifetime() const { return DebrisLifetime; }
-	float GetDebrisDespawnDuration() const { return DebrisDespawnDuration; }
-
-private:
-	// Called when the component is put to sleep.
-	void OnBeginDespawn();
-	
-	// Called when the component finishes dispawning.
-	void OnEndDespawn();
-
-	// Despawns the component immediately.
-	void DespawnImmediately();
-
-	// Checks if the debris component is still a part of the world.
-	bool CheckStillInWorld();
+	// UPrimitiveComponent Interface
+	virtual UBodySetup* GetBodySetup() override;
+
+	/**
+	 * Brings the debris back to life with a new mesh and transform. The mesh is only changed if it differs from the current one.
+	 * @param Piece Mesh, relative transform, mass and simple collision of the debris.
+	 * @param SpawnParameters Transform and velocity of the debris.
+	 */
+	void ActivateDebris(const FDebrisPieceParameters& Piece, const FDebrisSpawnParameters& SpawnParameters);
+
+	/**
+	 * Gives the pooled debris the mesh and simple collision of a piece ahead of its activation, activating it with the same piece keeps its body.
+	 * @param StaticMesh Mesh of the piece.
+	 * @param BodySetup Baked simple collision of the piece, the collision of the mesh is used if null.
+	 */
+	void PrewarmDebris(UStaticMesh* StaticMesh, UBodySetup* BodySetup);
+
+	/**
+	 * Stops the simulation and collision of the debris and removes it from the gravity field, the debris stays visible until EndDespawn is called.
+	 */
+	void BeginDespawn();
+
+	/**
+	 * Hides the debris, it can be activated again afterwards.
+	 */
+	void EndDespawn();
+
+	/**
+	 * Starts the fade of the debris material. Custom primitive data: [0] despawn start time, [1] despawn duration (world time in seconds).
+	 * @param StartTime World time at which the fade starts.
+	 * @param Duration Duration of the fade.
+	 */
+	void SetDespawnFade(float StartTime, float Duration);
+
+	/**
+	 * Checks if the debris is still a part of the world.
+	 * @param WorldSettings Settings of the world the debris is in.
+	 * @returns False if the debris fell below KillZ or left the world bounds.
+	 */
+	bool IsInsideWorldBounds(const AWorldSettings& WorldSettings) const;
+
+	void SetDebrisRecordIndex(int32 InRecordIndex) { DebrisRecordIndex = InRecordIndex; }
+
+	int32 GetDebrisRecordIndex() const { return DebrisRecordIndex; }
 
 private:
-	// Time of the debris until it despawns after being put to sleep.
-	UPROPERTY()
-	float DebrisLifetime;
-
-	// The duration of the despawn sequence.
-	UPROPERTY()
-	float DebrisDespawnDuration;
+	// Baked simple collision of the piece, replaces the body setup of the mesh while it is set.
+	UPROPERTY(Transient)
+	TObjectPtr<UBodySetup> DebrisBodySetup;
 
-	// Timeout until this component begins despawning.
-	float DebrisStartDespawnTimeout;
+	// Index of the record of this debris in the debris subsystem, INDEX_NONE while the debris is pooled.
+	int32 DebrisRecordIndex;
 
-	// Timeout until this component becomes inactive.
-	float DebrisDespawnTimeout;
+	// True if the custom primitive data holds a despawn fade which has to be reset on activation.
+	bool bIsFading;
 
-	// True if the component is in the process of dispawning.
-	bool bIsDispawning;
+	// True if the collision responses are set up for cosmetic debris.
+	bool bIsCosmetic;
 
-	// True if the debris is still being simulated and rendered.
-	bool bIsDebrisAlife;
+	// Collision responses of full debris which are restored when cosmetic debris is activated as full debris again.
+	FCollisionResponseContainer FullCollisionResponses;
 };
\ No newline at end of file
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <Components/SceneComponent.h>
+#include <PhysicsInterfaceDeclaresCore.h>
+
+#include "StasisControllerComponent.generated.h"
+
+class UPrimitiveComponent;
+class UDebrisStaticMeshComponent;
+class FStasisSimCallback;
+enum class EComponentPhysicsStateChange : uint8;
+
+/**
+ * Lifts many physics bodies into an orbit around the component and throws them all at once.
+ * Grabbed bodies are made kinematic and moved toward their orbit slots by kinematic targets in a sim callback before each physics step,
+ * so there are no per-object velocity updates on the game thread. The slots are kept as parallel arrays,
+ * the game thread sends them to the physics thread only in frames in which objects were grabbed or released.
+ * Debris pieces leave the despawn state machine of the debris subsystem while they are held, with bGrabSpawnedDebris the pieces
+ * of breaks close to the controller are grabbed as soon as they spawn.
+ */
+UCLASS(ClassGroup=Stasis, Blueprintable, meta=(BlueprintSpawnableComponent), MinimalAPI)
+class UStasisControllerComponent : public USceneComponent
+{
+	GENERATED_BODY()
+
+public:
+	UStasisControllerComponent();
+
+	// UActorComponent Interface
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/**
+	 * Lifts a simulating body or an active debris piece into the next free orbit slot.
+	 * @param Component The component, only its root body is moved.
+	 * @returns False if the component can not be grabbed or all slots are taken.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Stasis")
+	bool Grab(UPrimitiveComponent* Component);
+
+	/**
+	 * Grabs several components until all slots are taken.
+	 * @returns Number of grabbed components.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Stasis")
+	int32 GrabComponents(const TArray<UPrimitiveComponent*>& Components);
+
+	/**
+	 * Grabs the simulating bodies within GrabRadius with a single overlap query, the closest ones first.
+	 * @returns Number of grabbed components.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Stasis")
+	int32 GrabInRadius();
+
+	/**
+	 * Lets a grabbed component simulate again.
+	 * @param Component The grabbed component.
+	 * @param Impulse Velocity change which is applied on release in cm/s.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Stasis")
+	void Release(UPrimitiveComponent* Component, const FVector& Impulse);
+
+	/**
+	 * Releases all grabbed components at once. Each body keeps its orbit velocity and receives the impulses as velocity changes.
+	 * @param LinearImpulse Velocity change in cm/s which is applied to all bodies, e.g. to throw them forward.
+	 * @param RadialImpulse Velocity change in cm/s away from the orbit center.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Stasis")
+	void ReleaseAll(const FVector& LinearImpulse, float RadialImpulse);
+
+	/**
+	 * @returns Number of grabbed components.
+	 */
+	UFUNCTION(BlueprintPure, Category="Stasis")
+	int32 GetNumGrabbed() const { return GrabbedComponents.Num(); }
+
+protected:
+	// UActorComponent Interface
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/**
+	 * Maximum number of grabbed components.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Stasis", meta=(ClampMin="1"))
+	int32 MaxGrabbed;
+
+	/**
+	 * Radius in cm in which GrabInRadius and bGrabSpawnedDebris pick up objects.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Stasis", meta=(ClampMin="0"))
+	float GrabRadius;
+
+	/**
+	 * Grabs the pieces of debris spawns within GrabRadius right away.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Stasis")
+	bool bGrabSpawnedDebris;
+
+	/**
+	 * Radius of the orbit in cm.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Stasis", meta=(ClampMin="0"))
+	float OrbitRadius;
+
+	/**
+	 * Number of stacked orbit rings, the slots alternate between them.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Stasis", meta=(ClampMin="1"))
+	int32 NumOrbitRings;
+
+	/**
+	 * Vertical distance of the orbit rings in cm.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Stasis")
+	float OrbitRingSpacing;
+
+	/**
+	 * Angular speed of the orbit in deg/s.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Stasis")
+	float OrbitSpeed;
+
+	/**
+	 * Maximum speed in cm/s at which grabbed bodies move toward their slot.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Stasis", meta=(ClampMin="0"))
+	float PullSpeed;
+
+private:
+	// Returns the offset of an orbit slot from the orbit center before the orbit rotation.
+	FVector GetSlotOffset(int32 SlotIndex) const;
+
+	// Makes the body of a grabbed component simulate again and frees its slot.
+	void ReleaseSlot(int32 SlotIndex, const FVector& Impulse);
+
+	// Frees a slot, the last slot moves into it.
+	void RemoveSlot(int32 SlotIndex);
+
+	// Grabs the pieces of a debris spawn close to the controller.
+	void OnDebrisSpawned(TConstArrayView<UDebrisStaticMeshComponent*> SpawnedDebris);
+
+	// Drops grabbed components whose physics state is destroyed, the physics thread must not keep their proxies.
+	UFUNCTION()
+	void OnGrabbedPhysicsStateChanged(UPrimitiveComponent* ChangedComponent, EComponentPhysicsStateChange StateChange);
+
+private:
+	// Grabbed components, one per slot.
+	TArray<TWeakObjectPtr<UPrimitiveComponent>> GrabbedComponents;
+
+	// Physics proxies of the grabbed bodies, one per slot.
+	TArray<FPhysicsActorHandle> GrabbedProxies;
+
+	// Offsets of the orbit slots, one per slot.
+	TArray<FVector> SlotOffsets;
+
+	// Value of bUpdateKinematicFromSimulation of the grabbed bodies before they were grabbed, one per slot.
+	TBitArray<> UpdatedKinematicFromSimulation;
+
+	// Sim callback moving the grabbed bodies on the physics thread.
+	FStasisSimCallback* SimCallback;
+
+	// True if the physics thread has to receive the slots.
+	bool bSlotsDirty;
+};
\ No newline at end of file
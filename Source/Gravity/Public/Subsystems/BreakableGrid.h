@@ -0,0 +1,79 @@
+#pragma once
+
+#include <CoreMinimal.h>
+
+/**
+ * Loose uniform grid over the bounding spheres of breakables and their instances.
+ * An element lives only in the cell of its center, queries are grown by the largest element radius instead.
+ * This keeps insertion and removal at a single cell no matter how large the element is.
+ */
+class FBreakableGrid
+{
+public:
+	/**
+	 * @param InCellSize Edge length of a grid cell in cm.
+	 */
+	explicit FBreakableGrid(float InCellSize = 2000.0f);
+
+	/**
+	 * Adds an element, the id must not be in the grid already.
+	 * @param Id Id of the element chosen by the caller.
+	 * @param Center Center of the bounding sphere of the element.
+	 * @param Radius Radius of the bounding sphere of the element.
+	 */
+	void Add(int32 Id, const FVector& Center, float Radius);
+
+	/**
+	 * Removes an element, nothing happens if the id is not in the grid.
+	 */
+	void Remove(int32 Id);
+
+	/**
+	 * Collects the elements whose bounding sphere overlaps a box.
+	 * @param Box The query box.
+	 * @param OutIds Receives the ids of the overlapping elements.
+	 */
+	void Query(const FBox& Box, TArray<int32>& OutIds) const;
+
+	/**
+	 * @returns Number of elements in the grid.
+	 */
+	int32 Num() const { return NumElements; }
+
+private:
+	struct FElement
+	{
+		/** Center of the bounding sphere. */
+		FVector Center;
+
+		/** Radius of the bounding sphere. */
+		float Radius;
+
+		/** Cell the element is stored in. */
+		FIntVector Cell;
+
+		/** True if the element is in the grid. */
+		bool bIsValid = false;
+	};
+
+	FIntVector GetCell(const FVector& Location) const;
+
+private:
+	// Element ids per occupied cell.
+	TMap<FIntVector, TArray<int32>> Cells;
+
+	// Elements indexed by their id.
+	TArray<FElement> Elements;
+
+	// Edge length of a cell.
+	float CellSize;
+
+	// Largest radius of the elements in the grid, queries are grown by this radius.
+	float MaxRadius;
+
+	// Number of elements with the largest radius, the largest radius is searched again when the last of them is removed.
+	int32 NumMaxRadiusElements;
+
+	// Number of elements in the grid.
+	int32 NumElements;
+};
\ No newline at end of file
@@ -0,0 +1,328 @@
+#pragma once
+
+#include <CoreMinimal.h>
+#include <Subsystems/WorldSubsystem.h>
+#include <UObject/ObjectKey.h>
+#include <Stats/Stats.h>
+#include <ProfilingDebugging/CsvProfiler.h>
+
+#include "Subsystems/BreakableGrid.h"
+
+#include "BreakableSubsystem.generated.h"
+
+class ABreakableActorInterface;
+class UPrimitiveComponent;
+
+DECLARE_STATS_GROUP(TEXT("Breakables"), STATGROUP_Breakables, STATCAT_Advanced);
+
+CSV_DECLARE_CATEGORY_EXTERN(Breakables);
+
+/**
+ * The strongest hit a breakable or one of its instances received since the last batched pass.
+ */
+struct FBreakableHit
+{
+	/** The hit breakable. */
+	TWeakObjectPtr<ABreakableActorInterface> Breakable;
+
+	/** The hit component of the breakable. */
+	TWeakObjectPtr<UPrimitiveComponent> MyComponent;
+
+	/** The component which hit the breakable. */
+	TWeakObjectPtr<UPrimitiveComponent> OtherComponent;
+
+	/** Contact impulse of the hit in kg*cm/s. */
+	FVector NormalImpulse = FVector::ZeroVector;
+
+	/** The hit result. */
+	FHitResult Hit;
+};
+
+/**
+ * Frame times of the last finished breakable benchmark.
+ */
+struct FBreakableBenchmarkResult
+{
+	/** Sorted frame times of the benchmark frames in ms. */
+	TArray<float> FrameTimes;
+
+	/** Sorted game thread times of the benchmark frames in ms. */
+	TArray<float> GameThreadTimes;
+
+	/**
+	 * @param Percentile Percentile between 0 and 100, 100 is the slowest frame.
+	 * @returns The frame time in ms which is not exceeded by the percentile of the frames, zero if no frame was recorded.
+	 */
+	float GetFrameTime(int32 Percentile) const { return GetPercentile(FrameTimes, Percentile); }
+
+	/**
+	 * @param Percentile Percentile between 0 and 100, 100 is the slowest frame.
+	 * @returns The game thread time in ms which is not exceeded by the percentile of the frames, zero if no frame was recorded.
+	 */
+	float GetGameThreadTime(int32 Percentile) const { return GetPercentile(GameThreadTimes, Percentile); }
+
+private:
+	static float GetPercentile(const TArray<float>& SortedTimes, int32 Percentile)
+	{
+		const int32 sampleIndex = FMath::Clamp(FMath::CeilToInt32(Percentile / 100.0f * SortedTimes.Num()) - 1, 0, SortedTimes.Num() - 1);
+
+		return SortedTimes.IsValidIndex(sampleIndex) ? SortedTimes[sampleIndex] : 0.0f;
+	}
+};
+
+/**
+ * A breakable or one of its instances in the spatial index.
+ */
+struct FBreakableGridItem
+{
+	/** The registered breakable. */
+	TWeakObjectPtr<ABreakableActorInterface> Breakable;
+
+	/** Component which is passed to the break evaluation. */
+	TWeakObjectPtr<UPrimitiveComponent> Component;
+
+	/** Item index of the instance, INDEX_NONE for breakables without instances. */
+	int32 Item = INDEX_NONE;
+
+	/** Bounding sphere of the item when it was registered. */
+	FSphere Bounds = FSphere(ForceInit);
+
+	/** Movable items are not stored in the grid, their bounds are read from the component on each query. */
+	bool bIsMovable = false;
+};
+
+/**
+ * Impulse which an area-of-effect break applied to a breakable or one of its instances.
+ */
+struct FBreakableItemImpulse
+{
+	/** The affected breakable. */
+	TWeakObjectPtr<ABreakableActorInterface> Breakable;
+
+	/** Item index of the affected instance, INDEX_NONE for breakables without instances. */
+	int32 Item = INDEX_NONE;
+
+	/** Impulse in kg*cm/s after the falloff was applied. */
+	FVector Impulse = FVector::ZeroVector;
+
+	/** True if the impulse broke the breakable or instance. */
+	bool bIsBroken = false;
+};
+
+/**
+ * Coalesces the hit notifications of breakables and evaluates the breaks in one batched pass after physics.
+ * Resting or sliding bodies fire many contact callbacks per frame, only the strongest hit per breakable or ISM instance is kept.
+ * The render and physics state changes of the breaks are flushed once per breakable at the end of the pass.
+ * A breakable or instance which received a hit without breaking ignores weaker hits for a short cooldown (gravity.Breakable.RearmCooldown).
+ * Breakables and their instances are registered in a loose grid (gravity.Breakable.GridCellSize) for area-of-effect breaks like explosions
+ * or gravity kicks, broken items leave the grid and streamed out breakables unregister.
+ * Breaks spread to the items resting on a broken item through a budgeted queue if the breakable has baked support links.
+ * The broken items of streamed out breakables are kept as bit arrays keyed by the actor instance guid and restored when they stream in again.
+ */
+UCLASS(MinimalAPI)
+class UBreakableSubsystem final : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// UWorldSubsystem Interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	// FTickableGameObject Interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/**
+	 * Queues a hit of a breakable for the batched pass. Weaker hits of the same breakable or instance in the same frame are merged.
+	 * @param Breakable The hit breakable.
+	 * @param MyComponent The hit component of the breakable.
+	 * @param OtherComponent The component which hit the breakable.
+	 * @param NormalImpulse Contact impulse of the hit in kg*cm/s.
+	 * @param Hit The hit result, its MyItem identifies the hit instance.
+	 */
+	void QueueHit(ABreakableActorInterface* Breakable, UPrimitiveComponent* MyComponent, UPrimitiveComponent* OtherComponent, const FVector& NormalImpulse, const FHitResult& Hit);
+
+	/**
+	 * Calls OnFlushBreaks of the breakable at the end of the batched pass, so the breaks of a frame update the render and physics state once.
+	 * @param Breakable The breakable with pending state changes.
+	 */
+	void RequestFlush(ABreakableActorInterface* Breakable);
+
+	/**
+	 * Queues the break of an item which lost its support. The queue is drained in the tick under gravity.Breakable.PropagationsPerFrame,
+	 * so a large collapse spreads over several frames.
+	 * @param Breakable The supported breakable.
+	 * @param Item Item index of the supported instance, INDEX_NONE for breakables without instances.
+	 */
+	void QueueSupportedBreak(ABreakableActorInterface* Breakable, int32 Item);
+
+	/**
+	 * Keeps the broken state of a breakable which streams out.
+	 * @param BreakableGuid Instance guid of the breakable actor.
+	 * @param BrokenItems One bit per item, set for broken items.
+	 */
+	void StoreBrokenState(const FGuid& BreakableGuid, TBitArray<>&& BrokenItems);
+
+	/**
+	 * @param BreakableGuid Instance guid of the breakable actor.
+	 * @returns The broken state of a breakable which streamed out before or null if nothing of it was broken.
+	 */
+	const TBitArray<>* FindBrokenState(const FGuid& BreakableGuid) const { return BrokenStates.Find(BreakableGuid); }
+
+	/**
+	 * Adds the unbroken items of a breakable to the spatial index.
+	 */
+	void RegisterBreakable(ABreakableActorInterface* Breakable);
+
+	/**
+	 * Removes all items of a breakable from the spatial index.
+	 */
+	void UnregisterBreakable(ABreakableActorInterface* Breakable);
+
+	/**
+	 * Removes a broken item from the spatial index and counts the break for the stats.
+	 * @param Breakable The breakable the item belongs to.
+	 * @param Item Item index of the instance, INDEX_NONE for breakables without instances.
+	 */
+	void NotifyItemBroken(ABreakableActorInterface* Breakable, int32 Item);
+
+	/**
+	 * Applies an impulse to all breakables and instances in a sphere. The impulse points away from the origin and falls off linearly to the radius.
+	 * @param Origin Center of the sphere.
+	 * @param Radius Radius of the sphere.
+	 * @param Impulse Impulse in kg*cm/s at the origin.
+	 * @param OutImpulses Receives the affected items, can be null.
+	 * @returns Number of broken items.
+	 */
+	int32 BreakInRadius(const FVector& Origin, float Radius, float Impulse, TArray<FBreakableItemImpulse>* OutImpulses = nullptr);
+
+	/**
+	 * Applies the same impulse to all breakables and instances in a box.
+	 * @param Box The box.
+	 * @param Impulse Impulse in kg*cm/s.
+	 * @param OutImpulses Receives the affected items, can be null.
+	 * @returns Number of broken items.
+	 */
+	int32 BreakInBox(const FBox& Box, const FVector& Impulse, TArray<FBreakableItemImpulse>* OutImpulses = nullptr);
+
+	/**
+	 * Applies an impulse along a sweep to all breakables and instances in a capsule. The impulse falls off linearly from the axis to the radius.
+	 * @param Start Start of the sweep.
+	 * @param End End of the sweep.
+	 * @param Radius Radius of the swept sphere.
+	 * @param Impulse Impulse in kg*cm/s on the axis of the sweep.
+	 * @param OutImpulses Receives the affected items, can be null.
+	 * @returns Number of broken items.
+	 */
+	int32 BreakAlongSweep(const FVector& Start, const FVector& End, float Radius, float Impulse, TArray<FBreakableItemImpulse>* OutImpulses = nullptr);
+
+	/**
+	 * @returns Number of hits waiting for the batched pass.
+	 */
+	int32 GetNumPendingHits() const { return PendingHits.Num(); }
+
+	/**
+	 * Breaks registered items over several frames and records the frame times, the percentiles are logged and written to a CSV file
+	 * in the profiling directory. The automation test Gravity.Breakables.Benchmark runs it on TestArea3 and checks the budgets.
+	 * @param NumBreaks Number of items to break, chosen with a fixed seed so runs on the same map are comparable.
+	 * @param BreaksPerFrame Number of items broken per frame.
+	 */
+	void StartBenchmark(int32 NumBreaks, int32 BreaksPerFrame);
+
+	/**
+	 * @returns True while a benchmark is running.
+	 */
+	bool IsBenchmarkRunning() const { return BenchmarkBreaksPerFrame > 0; }
+
+	/**
+	 * @returns The frame times of the last finished benchmark, empty if no benchmark finished since the last start.
+	 */
+	const FBreakableBenchmarkResult& GetBenchmarkResult() const { return BenchmarkResult; }
+
+protected:
+	// UWorldSubsystem Interface
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	// Identifies a breakable and the hit item, INDEX_NONE for breakables without instances.
+	using FBreakableHitKey = TPair<FObjectKey, int32>;
+
+	// Evaluates the queued hits and spawns the debris of the broken ones.
+	void ProcessPendingHits(double Time);
+
+	// Breaks the queued supported items up to the per-frame budget.
+	void ProcessSupportedBreaks();
+
+	// Collects the grid items whose bounding sphere overlaps a box together with their current bounds.
+	void QueryGridItems(const FBox& Box, TArray<TPair<int32, FSphere>>& OutItems);
+
+	// Evaluates the impulses of an area-of-effect break in one pass.
+	int32 ApplyItemImpulses(TArray<FBreakableItemImpulse>& Impulses);
+
+	// Breaks the next items of the benchmark and records the frame time.
+	void UpdateBenchmark();
+
+	// Logs and writes the frame time percentiles of the benchmark.
+	void FinishBenchmark();
+
+private:
+	// The strongest hit per breakable or instance of the current frame.
+	TArray<FBreakableHit> PendingHits;
+
+	// Index of the pending hit of a breakable or instance.
+	TMap<FBreakableHitKey, int32> PendingHitIndices;
+
+	// Breakables whose OnFlushBreaks is called at the end of the batched pass.
+	TArray<TWeakObjectPtr<ABreakableActorInterface>> PendingFlushes;
+
+	// Time until which a breakable or instance ignores hits that cannot break it on their own.
+	TMap<FBreakableHitKey, double> RearmTimes;
+
+	// Registered breakables and instances, the index is the id in the grid.
+	TSparseArray<FBreakableGridItem> GridItems;
+
+	// Index of the grid item of a breakable or instance.
+	TMap<FBreakableHitKey, int32> GridItemIndices;
+
+	// Indices of the grid items of a breakable, so unregistering a breakable only visits its own items.
+	TMap<FObjectKey, TArray<int32>> BreakableGridItemIndices;
+
+	// Movable grid items which are tested on every query.
+	TArray<int32> MovableGridItems;
+
+	// Supported items waiting for their break in the order of their queueing.
+	TArray<TPair<TWeakObjectPtr<ABreakableActorInterface>, int32>> SupportedBreakQueue;
+
+	// Index of the next supported break in the queue.
+	int32 SupportedBreakQueueHead = 0;
+
+	// Broken items of breakables which streamed out, one bit per item.
+	TMap<FGuid, TBitArray<>> BrokenStates;
+
+	// Number of broken items since the last tick.
+	int32 NumBreaksThisFrame = 0;
+
+	// Items which are broken by the running benchmark.
+	TArray<TPair<TWeakObjectPtr<ABreakableActorInterface>, int32>> BenchmarkBreaks;
+
+	// Index of the next item the benchmark breaks.
+	int32 BenchmarkBreakIndex = 0;
+
+	// Number of items the benchmark breaks per frame, zero if no benchmark is running.
+	int32 BenchmarkBreaksPerFrame = 0;
+
+	// Number of frames the benchmark keeps recording after the last break.
+	int32 BenchmarkSettleFrames = 0;
+
+	// Frame and game thread times in ms of the benchmark frames.
+	TArray<TPair<float, float>> BenchmarkFrameTimes;
+
+	// Frame times of the last finished benchmark.
+	FBreakableBenchmarkResult BenchmarkResult;
+
+	// Spatial index of the static grid items.
+	FBreakableGrid Grid;
+
+	// Reused query result.
+	TArray<int32> GridQueryIds;
+};
\ No newline at end of file
@@ -0,0 +1,480 @@
+#pragma once
+
+#include <CoreMinimal.h>
+#include <Subsystems/WorldSubsystem.h>
+#include <Engine/StreamableManager.h>
+
+#include "Subsystems/DebrisTimerWheel.h"
+
+#include "DebrisSubsystem.generated.h"
+
+class UStaticMesh;
+class UPhysicalMaterial;
+class UBodySetup;
+class ADebrisStaticMeshActor;
+class UDebrisStaticMeshComponent;
+class UPrimitiveComponent;
+class UInstancedStaticMeshComponent;
+class UBreakableFractureData;
+class ABreakableActorInterface;
+class UMaterialParameterCollection;
+class UMaterialParameterCollectionInstance;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogGravityDebris, Display, All)
+
+USTRUCT()
+struct FDebrisPieceParameters
+{
+	GENERATED_BODY()
+
+	/** Mesh of the debris piece. */
+	UPROPERTY()
+	TObjectPtr<UStaticMesh> StaticMesh;
+
+	/** Transform of the piece relative to the spawn transform. */
+	FTransform RelativeTransform = FTransform::Identity;
+
+	/** Mass of the piece in kg, the mass computed from the mesh is used if zero. */
+	float Mass = 0.0f;
+
+	/** Simple collision the piece simulates against, the collision of the mesh is used if null. */
+	UPROPERTY()
+	TObjectPtr<UBodySetup> BodySetup;
+};
+
+USTRUCT()
+struct FDebrisSpawnParameters
+{
+	GENERATED_BODY()
+
+	/** The debris pieces, pieces without a mesh are skipped. */
+	UPROPERTY()
+	TArray<FDebrisPieceParameters> Pieces;
+
+	/** Physical material of the debris pieces (no override if null). */
+	UPROPERTY()
+	TObjectPtr<UPhysicalMaterial> PhysicalMaterial;
+
+	/** World transform of the debris spawn point. */
+	FTransform Transform = FTransform::Identity;
+
+	/** Initial linear velocity of the debris pieces. */
+	FVector LinearVelocity = FVector::ZeroVector;
+
+	/** Time of the debris until it despawns after being put to sleep. */
+	float Lifetime = 5.0f;
+
+	/** Duration of the despawn sequence. */
+	float DespawnDuration = 2.0f;
+
+	/** Cosmetic debris only collides with the static world and does not generate queries or hits. */
+	bool bIsCosmetic = false;
+};
+
+USTRUCT()
+struct FDebrisSpawnRequest
+{
+	GENERATED_BODY()
+
+	/** Parameters of the queued spawn. */
+	UPROPERTY()
+	FDebrisSpawnParameters SpawnParameters;
+
+	/** Time at which the spawn was queued. */
+	double RequestTime = 0.0;
+};
+
+UENUM()
+enum class EDebrisState : uint8
+{
+	Simulating	UMETA(Tooltip="The debris is simulated and waits for its body to fall asleep."),
+	Sleeping	UMETA(Tooltip="The body of the debris is asleep and the despawn timer is running."),
+	Frozen		UMETA(Tooltip="The debris was made kinematic to stay within the simulation budget, the despawn timer is running."),
+	Despawning	UMETA(Tooltip="The debris is frozen and waits for the end of the despawn sequence."),
+	Held		UMETA(Tooltip="The debris is moved kinematically by a stasis controller, it does not despawn and is not evicted.")
+};
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnDebrisSpawned, TConstArrayView<UDebrisStaticMeshComponent*>);
+
+/**
+ * State of a single active debris piece. The records are stored in one contiguous array, free records are reused.
+ */
+USTRUCT()
+struct FDebrisRecord
+{
+	GENERATED_BODY()
+
+	/** The debris piece. */
+	UPROPERTY()
+	TObjectPtr<UDebrisStaticMeshComponent> Component;
+
+	/** Actor owning the debris piece, it is returned to the pool when all of its pieces despawned. */
+	UPROPERTY()
+	TObjectPtr<ADebrisStaticMeshActor> Actor;
+
+	/** Time of the debris until it despawns after being put to sleep. */
+	float Lifetime = 0.0f;
+
+	/** Duration of the despawn sequence. */
+	float DespawnDuration = 0.0f;
+
+	/** Time at which the debris was spawned. */
+	double SpawnTime = 0.0;
+
+	/** Incremented on every state change, timers of older generations are ignored. */
+	uint32 Generation = 0;
+
+	/** Current state of the debris. */
+	EDebrisState State = EDebrisState::Simulating;
+};
+
+/**
+ * Settled debris of one mesh, rendered as instances of a single ISM component without physics bodies.
+ * Per-instance custom data: [0] despawn start time, [1] despawn duration (world time in seconds), the material fades the instance with it.
+ * Debris components use the same layout in their custom primitive data.
+ */
+USTRUCT()
+struct FSettledDebrisBatch
+{
+	GENERATED_BODY()
+
+	/** Renders all settled debris of the mesh. */
+	UPROPERTY()
+	TObjectPtr<UInstancedStaticMeshComponent> Component;
+
+	/** Time at which each instance finishes despawning, negative for free instances. */
+	TArray<double> InstanceEndTimes;
+
+	/** Instances which finished despawning, they are scaled to zero and reused by new settled debris. */
+	TArray<int32> FreeInstances;
+
+	/** Earliest end time of all instances in use. */
+	double NextEndTime = TNumericLimits<double>::Max();
+};
+
+/**
+ * A breakable whose debris meshes are streamed in while it is close to the player.
+ */
+struct FBreakablePrefetchEntry
+{
+	/** The registered breakable. */
+	TWeakObjectPtr<ABreakableActorInterface> Breakable;
+
+	/** Fracture data of the breakable. */
+	TWeakObjectPtr<UBreakableFractureData> FractureData;
+
+	/** True if the breakable holds a reference to its fracture data. */
+	bool bIsInRange = false;
+};
+
+/**
+ * Streaming state of fracture data which is referenced by breakables in range.
+ */
+struct FFracturePrefetch
+{
+	/** Keeps the piece meshes loaded. */
+	TSharedPtr<FStreamableHandle> StreamingHandle;
+
+	/** Number of breakables in range using the fracture data. */
+	int32 NumReferences = 0;
+};
+
+/**
+ * Keeps a pool of debris actors so breaking an object does not spawn actors, create components or physics bodies.
+ * The pool is pre-warmed at the begin of play with the meshes of the generic FallbackFractureData,
+ * and a pooled actor takes the meshes of the fracture data of a breakable as soon as they are streamed in.
+ * Debris pieces do not tick. The subsystem listens to the sleep and wake events of their bodies and schedules the despawn
+ * of sleeping pieces in a timer wheel, so awake debris costs nothing except for a round-robin world bounds check.
+ * The number of simulating and total debris pieces is capped by a budget (gravity.Debris.MaxSimulating, gravity.Debris.MaxTotal),
+ * the least relevant pieces are evicted to make room for new ones and spawns beyond the budget spawn fewer pieces.
+ * Debris that fell asleep is moved into per-mesh instanced components for the rest of its life (gravity.Debris.InstanceSettledDebris),
+ * its component and actor return to the pool right away.
+ * Debris actors return to the pool once all of their pieces despawned.
+ * The debris meshes of breakables are streamed in asynchronously while the player or a prefetch source is in range of the breakable
+ * (gravity.Debris.PrefetchRadius), breaks before the meshes are loaded spawn the fallback debris instead.
+ * Debris held by a stasis controller leaves the despawn state machine and the budget eviction until it is released.
+ */
+UCLASS(Config=Game, MinimalAPI)
+class UDebrisSubsystem final : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// UWorldSubsystem Interface
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	// FTickableGameObject Interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/**
+	 * Checks out a debris actor from the pool and activates its pieces.
+	 * @param SpawnParameters Meshes, transform and velocity of the debris.
+	 * @returns The activated debris actor or nullptr if there was nothing to spawn.
+	 */
+	ADebrisStaticMeshActor* SpawnDebris(const FDebrisSpawnParameters& SpawnParameters);
+
+	/**
+	 * Queues a debris spawn. The queue is drained in the subsystem tick under a per-frame piece and time budget,
+	 * spawns closest to the viewer first. Spawns which waited longer than gravity.Debris.SpawnQueueMaxDelay are discarded.
+	 * @param SpawnParameters Meshes, transform and velocity of the debris.
+	 */
+	void QueueDebris(const FDebrisSpawnParameters& SpawnParameters);
+
+	/**
+	 * @param OutViewLocation Receives the location of the first local player's view.
+	 * @returns False if there is no player.
+	 */
+	bool GetViewLocation(FVector& OutViewLocation) const;
+
+	/**
+	 * Returns a debris actor to the pool. All pieces of the actor must be despawned.
+	 * @param DebrisActor The actor to release.
+	 */
+	void ReleaseDebris(ADebrisStaticMeshActor* DebrisActor);
+
+	/**
+	 * @returns Number of debris actors that are waiting in the pool.
+	 */
+	int32 GetNumFreeDebrisActors() const { return FreeDebrisActors.Num(); }
+
+	/**
+	 * @returns Number of debris pieces that are simulating or despawning.
+	 */
+	int32 GetNumActiveDebris() const { return DebrisRecords.Num() - FreeRecordIndices.Num(); }
+
+	/**
+	 * @returns Number of debris pieces whose bodies are simulated (awake or asleep).
+	 */
+	int32 GetNumSimulatingDebris() const { return NumSimulatingDebris; }
+
+	/**
+	 * @returns Number of settled debris instances which did not finish despawning.
+	 */
+	int32 GetNumSettledDebris() const { return NumSettledDebris; }
+
+	/**
+	 * @returns Number of debris physics bodies including the ones of pooled debris.
+	 */
+	int32 GetNumDebrisBodies() const { return NumDebrisBodies; }
+
+	/**
+	 * Registers a breakable for the streaming of its debris meshes.
+	 */
+	void RegisterBreakable(ABreakableActorInterface* Breakable);
+
+	/**
+	 * Unregisters a breakable and releases its debris meshes.
+	 */
+	void UnregisterBreakable(ABreakableActorInterface* Breakable);
+
+	/**
+	 * Adds an actor which streams in the debris meshes of nearby breakables, e.g. a physics threat like a projectile or a vehicle.
+	 */
+	void AddPrefetchSource(AActor* Source);
+
+	/**
+	 * Removes a prefetch source.
+	 */
+	void RemovePrefetchSource(AActor* Source);
+
+	/**
+	 * Takes a debris piece out of the despawn state machine, e.g. while it is held by a stasis controller.
+	 * The caller makes the body kinematic and is responsible for it until ReleaseHeldDebris is called.
+	 * @param Component The debris piece.
+	 * @returns False if the debris is not active or already despawning.
+	 */
+	bool HoldDebris(UDebrisStaticMeshComponent* Component);
+
+	/**
+	 * Hands a held debris piece back to the despawn state machine, the caller has to simulate its body again.
+	 * @param Component The debris piece.
+	 */
+	void ReleaseHeldDebris(UDebrisStaticMeshComponent* Component);
+
+	/**
+	 * Broadcast with the pieces of every debris spawn, e.g. to grab the pieces of a break right away.
+	 */
+	FOnDebrisSpawned OnDebrisSpawned;
+
+	/**
+	 * @returns Generic debris which is spawned if the debris meshes of a breakable are not loaded yet, can be null.
+	 */
+	UBreakableFractureData* GetFallbackFractureData() const { return LoadedFallbackFractureData; }
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	// Spawns an inactive debris actor for the pool.
+	ADebrisStaticMeshActor* SpawnPooledActor();
+
+	// Takes the best fitting actor out of the pool or spawns a new one if the pool is empty.
+	ADebrisStaticMeshActor* AcquireActor(const FDebrisSpawnParameters& SpawnParameters, int32 NumDebris);
+
+	// Gives a pooled actor the meshes of a fracture unless its pre-warmed actor still has them, so breaks find pooled bodies with the right shapes.
+	void PrewarmFractureData(const UBreakableFractureData& FractureData);
+
+	// Returns true if a pooled actor is reserved for the meshes of a fracture.
+	bool IsPrewarmedActor(const ADebrisStaticMeshActor* DebrisActor) const;
+
+	// Frees the reservation of a pooled actor, e.g. because it is taken out of the pool.
+	void RemovePrewarmedActor(const ADebrisStaticMeshActor* DebrisActor);
+
+	// Hides the debris of a record, frees the record and releases the actor if this was the last alive piece.
+	void FinishDespawn(int32 RecordIndex);
+
+	// Stops the simulation of the debris and schedules the end of the despawn sequence.
+	void BeginDespawn(int32 RecordIndex, double Time, float DespawnDuration);
+
+	// Makes the debris kinematic and schedules its despawn, the debris keeps colliding.
+	void FreezeDebris(int32 RecordIndex, double Time);
+
+	// Evicts debris to make room for new pieces. Returns the number of pieces that fit into the budget.
+	int32 ApplyDebrisBudget(int32 NumRequestedDebris, double Time);
+
+	// Evicts the least relevant debris pieces.
+	void EvictDebris(int32 NumSimulatingToEvict, int32 NumTotalToEvict, double Time);
+
+	// Spawns queued debris until the per-frame budget is used up.
+	void DrainSpawnQueue(double Time);
+
+	// Streams in or releases the debris meshes of a limited number of breakables depending on their distance to the prefetch sources.
+	void UpdatePrefetch();
+
+	// Adds a reference to fracture data, the first reference starts streaming its meshes.
+	void AddFractureReference(UBreakableFractureData* FractureData);
+
+	// Removes a reference from fracture data, the last reference releases its meshes.
+	void ReleaseFractureReference(UBreakableFractureData* FractureData);
+
+	// Called when the meshes of fracture data finished streaming.
+	void OnFractureDataLoaded(TWeakObjectPtr<UBreakableFractureData> FractureData);
+
+	// Returns how much a debris piece is suited for eviction, older, farther and off-screen debris scores higher.
+	float GetEvictionScore(const FDebrisRecord& DebrisRecord, double Time, const FVector* ViewLocation) const;
+
+	// Moves sleeping debris into the instanced component of its mesh and frees the record.
+	void SettleDebris(int32 RecordIndex, double Time);
+
+	// Removes the settled debris instances which finished despawning.
+	void UpdateSettledDebris(double Time);
+
+	// Returns the settled debris batch of a mesh, the batch is created on first use.
+	FSettledDebrisBatch& GetSettledDebrisBatch(UStaticMesh* StaticMesh);
+
+	// Runs the world bounds check for a limited number of simulating debris pieces.
+	void CheckWorldBounds();
+
+	// Called by the physics scene when a debris body falls asleep.
+	UFUNCTION()
+	void OnDebrisSleep(UPrimitiveComponent* SleepingComponent, FName BoneName);
+
+	// Called by the physics scene when a debris body wakes up.
+	UFUNCTION()
+	void OnDebrisWake(UPrimitiveComponent* WakingComponent, FName BoneName);
+
+	// Returns the record of a debris component or nullptr if the component is not active.
+	FDebrisRecord* FindRecord(const UPrimitiveComponent* Component, int32& OutRecordIndex);
+
+protected:
+	/**
+	 * Generic and cheap debris which is always resident.
+	 */
+	UPROPERTY(Config)
+	TSoftObjectPtr<UBreakableFractureData> FallbackFractureData;
+
+	/**
+	 * Collection which receives the world time each frame, debris materials compare it with the despawn start time
+	 * in their custom primitive data or per-instance custom data to fade out without any per-piece CPU work.
+	 */
+	UPROPERTY(Config)
+	TSoftObjectPtr<UMaterialParameterCollection> DespawnParameterCollection;
+
+	/**
+	 * Scalar parameter of the DespawnParameterCollection which receives the world time.
+	 */
+	UPROPERTY(Config)
+	FName DespawnTimeParameterName = TEXT("DebrisTime");
+
+private:
+	// Inactive debris actors ready to be checked out.
+	UPROPERTY()
+	TArray<TObjectPtr<ADebrisStaticMeshActor>> FreeDebrisActors;
+
+	// State of all active debris pieces, records without a component are free.
+	UPROPERTY()
+	TArray<FDebrisRecord> DebrisRecords;
+
+	// Indices of the free debris records.
+	TArray<int32> FreeRecordIndices;
+
+	// Despawn timers of the sleeping and despawning debris.
+	FDebrisTimerWheel DespawnTimers;
+
+	// Scratch array for the timers which are due this frame.
+	TArray<FDebrisTimerWheel::FTimer> DueTimers;
+
+	// Record index at which the next world bounds check continues.
+	int32 WorldBoundsCheckCursor = 0;
+
+	// Number of debris pieces in the simulating or sleeping state.
+	int32 NumSimulatingDebris = 0;
+
+	// Scratch array for the eviction scores and record indices of the eviction candidates.
+	TArray<TPair<float, int32>> EvictionCandidates;
+
+	// Debris spawns waiting to be drained.
+	UPROPERTY()
+	TArray<FDebrisSpawnRequest> SpawnQueue;
+
+	// Records that fell asleep since the last tick and are moved into the settled debris batches.
+	TArray<FDebrisTimerWheel::FTimer> PendingSettledDebris;
+
+	// Actor owning the instanced components of the settled debris.
+	UPROPERTY()
+	TObjectPtr<AActor> SettledDebrisActor;
+
+	// Settled debris grouped by mesh.
+	UPROPERTY()
+	TArray<FSettledDebrisBatch> SettledDebrisBatches;
+
+	// Index of the settled debris batch of each mesh.
+	TMap<TObjectKey<UStaticMesh>, int32> SettledDebrisBatchIndices;
+
+	// Number of settled debris instances in use.
+	int32 NumSettledDebris = 0;
+
+	// Number of debris components of the pooled and active actors, every component owns a physics body.
+	int32 NumDebrisBodies = 0;
+
+	// Instance of the DespawnParameterCollection in this world.
+	UPROPERTY(Transient)
+	TObjectPtr<UMaterialParameterCollectionInstance> DespawnParameterCollectionInstance;
+
+	// The loaded fallback fracture data.
+	UPROPERTY(Transient)
+	TObjectPtr<UBreakableFractureData> LoadedFallbackFractureData;
+
+	// Pooled actor holding the meshes of a loaded fracture, other fractures do not pre-warm into it until it leaves the pool.
+	TMap<TObjectKey<UBreakableFractureData>, TWeakObjectPtr<ADebrisStaticMeshActor>> PrewarmedFractureActors;
+
+	// Breakables registered for the streaming of their debris meshes.
+	TArray<FBreakablePrefetchEntry> PrefetchEntries;
+
+	// Entry index at which the next prefetch update continues.
+	int32 PrefetchCursor = 0;
+
+	// Actors besides the player which stream in the debris meshes of nearby breakables.
+	TArray<TWeakObjectPtr<AActor>> PrefetchSources;
+
+	// Streaming state of the fracture data in range.
+	TMap<TObjectKey<UBreakableFractureData>, FFracturePrefetch> FracturePrefetches;
+
+	// Streams the debris meshes.
+	FStreamableManager StreamableManager;
+
+	// Scratch array for the debris pieces activated by a spawn.
+	TArray<UDebrisStaticMeshComponent*> ActivatedDebris;
+};
\ No newline at end of file
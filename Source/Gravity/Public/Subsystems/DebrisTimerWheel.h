@@ -0,0 +1,65 @@
+#pragma once
+
+#include <CoreMinimal.h>
+
+/**
+ * Hashed timer wheel for the despawn timers of debris.
+ * Timers are bucketed by their due time, advancing the wheel only visits the buckets that became due since the last advance.
+ * Timers are never cancelled, they carry the generation of their debris record and are ignored by the caller when the record moved on.
+ */
+class FDebrisTimerWheel
+{
+public:
+	struct FTimer
+	{
+		/** Index of the debris record the timer belongs to. */
+		int32 RecordIndex;
+
+		/** Generation of the debris record when the timer was scheduled. */
+		uint32 Generation;
+
+		/** Time at which the timer fires. */
+		double DueTime;
+	};
+
+	/**
+	 * @param InSlotDuration Time span covered by one slot of the wheel.
+	 * @param InNumSlots Number of slots, must be a power of two.
+	 */
+	explicit FDebrisTimerWheel(double InSlotDuration = 0.125, int32 InNumSlots = 128);
+
+	/**
+	 * Schedules a timer. Timers that are already due fire on the next advance.
+	 */
+	void Schedule(int32 RecordIndex, uint32 Generation, double DueTime);
+
+	/**
+	 * Advances the wheel to the given time.
+	 * @param Time The current time, must not be smaller than the time of the previous advance.
+	 * @param OutDueTimers Receives all timers that are due.
+	 */
+	void Advance(double Time, TArray<FTimer>& OutDueTimers);
+
+	/**
+	 * @returns Number of scheduled timers, including the ones that became stale.
+	 */
+	int32 Num() const { return NumTimers; }
+
+private:
+	int64 GetTick(double Time) const { return FMath::Max<int64>(FMath::FloorToInt64(Time / SlotDuration), 0); }
+
+	int32 GetSlotIndex(int64 Tick) const { return static_cast<int32>(Tick & (Slots.Num() - 1)); }
+
+private:
+	// Timers bucketed by the tick of their due time.
+	TArray<TArray<FTimer>> Slots;
+
+	// Time span covered by one slot.
+	double SlotDuration;
+
+	// Tick of the last advance.
+	int64 CurrentTick;
+
+	// Number of timers in all slots.
+	int32 NumTimers;
+};
\ No newline at end of file
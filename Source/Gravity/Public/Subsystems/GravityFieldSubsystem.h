@@ -0,0 +1,192 @@
+#pragma once
+
+#include <CoreMinimal.h>
+#include <Subsystems/WorldSubsystem.h>
+#include <UObject/ObjectKey.h>
+#include <PhysicsInterfaceDeclaresCore.h>
+#include <Stats/Stats.h>
+
+#include "GravityFieldSubsystem.generated.h"
+
+class UPrimitiveComponent;
+class FGravityFieldSimCallback;
+class FPhysScene_Chaos;
+enum class EComponentPhysicsStateChange : uint8;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogGravityField, Display, All)
+
+DECLARE_STATS_GROUP(TEXT("Gravity Field"), STATGROUP_GravityField, STATCAT_Advanced);
+
+/**
+ * Oriented box in which the gravity of the registered bodies is replaced.
+ */
+USTRUCT(BlueprintType)
+struct FGravityFieldRegion
+{
+	GENERATED_BODY()
+
+	/** Transform of the box, the scale is ignored. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Gravity")
+	FTransform Transform = FTransform::Identity;
+
+	/** Half size of the box in cm. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Gravity")
+	FVector Extent = FVector(100.0);
+
+	/** Gravity acceleration in cm/s^2 in world space. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Gravity")
+	FVector Gravity = FVector::ZeroVector;
+
+	/** The region with the highest priority decides the gravity where regions overlap. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Gravity")
+	int32 Priority = 0;
+
+	/**
+	 * @returns True if the location is inside the box.
+	 */
+	bool IsInside(const FVector& Location) const
+	{
+		const FVector localLocation = Transform.InverseTransformPositionNoScale(Location);
+
+		return FMath::Abs(localLocation.X) <= Extent.X && FMath::Abs(localLocation.Y) <= Extent.Y && FMath::Abs(localLocation.Z) <= Extent.Z;
+	}
+};
+
+/**
+ * Body whose gravity is controlled by the gravity field.
+ */
+struct FGravityFieldBody
+{
+	/** The registered component. */
+	TWeakObjectPtr<UPrimitiveComponent> Component;
+
+	/** Physics proxy of the body, null while the component has no physics state. */
+	FPhysicsActorHandle Proxy = nullptr;
+
+	/** Gravity acceleration of the body in cm/s^2, replaces the gravity of the regions if bHasGravity is set. */
+	FVector Gravity = FVector::ZeroVector;
+
+	/** True if the body has its own gravity. */
+	bool bHasGravity = false;
+};
+
+/**
+ * Replaces the gravity of many rigid bodies per region or per body, e.g. for gravity shifts or lifted and thrown props and debris.
+ * The gravity is applied on the physics thread in a sim callback before each step as a single batched force pass over the registered bodies,
+ * the force is the difference to the world gravity so registered bodies keep their engine gravity enabled.
+ * The game thread sends a snapshot of the bodies and regions to the physics thread right before the physics step of a frame in which they changed.
+ * Bodies are identified by their physics proxy. The subsystem follows the physics state changes of the registered components,
+ * a destroyed body leaves the snapshot of the same step and a recreated body continues with its new proxy.
+ */
+UCLASS(MinimalAPI)
+class UGravityFieldSubsystem final : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// UWorldSubsystem Interface
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	/**
+	 * Puts the body of a component under the control of the gravity field. Only the root body of the component is affected.
+	 * @param Component The component, it needs a physics state.
+	 * @returns True if the body was registered.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Gravity")
+	bool RegisterBody(UPrimitiveComponent* Component);
+
+	/**
+	 * Gives the body of a component back to the world gravity.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Gravity")
+	void UnregisterBody(UPrimitiveComponent* Component);
+
+	/**
+	 * Gives a body its own gravity regardless of the regions, the body is registered if needed.
+	 * @param Component The component of the body.
+	 * @param Gravity Gravity acceleration in cm/s^2 in world space.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Gravity")
+	void SetBodyGravity(UPrimitiveComponent* Component, const FVector& Gravity);
+
+	/**
+	 * Lets the regions decide the gravity of a body again.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Gravity")
+	void ClearBodyGravity(UPrimitiveComponent* Component);
+
+	/**
+	 * Adds a gravity region, the registered bodies inside the region are woken up.
+	 * @returns Id of the region.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Gravity")
+	int32 AddRegion(const FGravityFieldRegion& Region);
+
+	/**
+	 * Changes a gravity region, the registered bodies inside the old and new region are woken up.
+	 * @param RegionId Id returned by AddRegion.
+	 * @param Region The new region.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Gravity")
+	void UpdateRegion(int32 RegionId, const FGravityFieldRegion& Region);
+
+	/**
+	 * Removes a gravity region, the registered bodies inside the region are woken up.
+	 * @param RegionId Id returned by AddRegion.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Gravity")
+	void RemoveRegion(int32 RegionId);
+
+	/**
+	 * @param Location World location.
+	 * @returns Gravity acceleration in cm/s^2 of the regions at a location, the world gravity outside of all regions.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Gravity")
+	FVector GetGravityAtLocation(const FVector& Location) const;
+
+	/**
+	 * @returns Number of registered bodies.
+	 */
+	int32 GetNumBodies() const { return Bodies.Num(); }
+
+protected:
+	// UWorldSubsystem Interface
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	// Wakes the registered bodies inside a region, so sleeping bodies react to the changed gravity.
+	void WakeBodiesInRegion(const FGravityFieldRegion& Region);
+
+	// Sends the bodies and regions to the physics thread.
+	void PushSnapshot();
+
+	// Called by the physics scene on the game thread before the physics step, sends the snapshot if something changed.
+	void OnPhysScenePreTick(FPhysScene_Chaos* PhysicsScene, float DeltaTime);
+
+	// Keeps the proxy of a registered body up to date when its physics state is destroyed or created.
+	UFUNCTION()
+	void OnBodyPhysicsStateChanged(UPrimitiveComponent* ChangedComponent, EComponentPhysicsStateChange StateChange);
+
+	// Returns the world gravity as a vector.
+	FVector GetWorldGravity() const;
+
+private:
+	// Registered bodies by their component.
+	TMap<TObjectKey<UPrimitiveComponent>, FGravityFieldBody> Bodies;
+
+	// Gravity regions, the index is the id of the region.
+	TSparseArray<FGravityFieldRegion> Regions;
+
+	// Sim callback applying the gravity on the physics thread.
+	FGravityFieldSimCallback* SimCallback = nullptr;
+
+	// World gravity of the last snapshot.
+	FVector SnapshotWorldGravity = FVector::ZeroVector;
+
+	// Binding to the pre-tick of the physics scene.
+	FDelegateHandle PhysScenePreTickHandle;
+
+	// True if the physics thread has to receive a new snapshot.
+	bool bIsDirty = false;
+};
\ No newline at end of file